@@ -0,0 +1,175 @@
+#ifndef ASTARENGINE_H
+#define ASTARENGINE_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The heuristic policy of the AStarEngine for graphs without usable coordinates.
+* A heuristic provides estimate(node), a lower bound of the distance from node to the target.
+* With this one, A* settles the same nodes as Dijkstra's algorithm.
+*/
+class ZeroHeuristic
+{
+public:
+    double estimate(CsrGraph::tIndex) const { return 0.0; }
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Great circle distance to the target as A* heuristic for geo graphs.
+*
+* It uses the same haversine formula as GeoJSONGraphConverter, whose edge weights are the great
+* circle distances in km between their nodes, so the estimate is a lower bound there. If the
+* weights are e.g. travel times, pass the minimum weight per km (1 / maximum speed) as factor.
+*/
+class HaversineHeuristic
+{
+public:
+
+    HaversineHeuristic(const CsrGraph& rGraph, CsrGraph::tIndex target, double weightPerKm = 1.0)
+        : m_rGraph(rGraph),
+          m_targetLon(rGraph.getLon(target) * DEG_TO_RAD),
+          m_targetLat(rGraph.getLat(target) * DEG_TO_RAD),
+          m_cosTargetLat(std::cos(m_targetLat)),
+          m_factor(2.0 * EARTH_RADIUS_KM * weightPerKm) { }
+
+    double estimate(CsrGraph::tIndex node) const {
+        double lon = m_rGraph.getLon(node) * DEG_TO_RAD;
+        double lat = m_rGraph.getLat(node) * DEG_TO_RAD;
+        double sinDLat = std::sin((m_targetLat - lat) / 2);
+        double sinDLon = std::sin((m_targetLon - lon) / 2);
+        double a = sinDLat * sinDLat + sinDLon * sinDLon * std::cos(lat) * m_cosTargetLat;
+        return m_factor * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+    }
+
+private:
+
+    static constexpr double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+    static constexpr double EARTH_RADIUS_KM = 6371.0;
+
+    const CsrGraph& m_rGraph;
+    double m_targetLon;
+    double m_targetLat;
+    double m_cosTargetLat;
+    double m_factor;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Point to point A* search on a CsrGraph. The search is guided to the target by a heuristic
+* policy, see ZeroHeuristic and HaversineHeuristic. The path is a shortest path, if the heuristic
+* never overestimates and is consistent (h(u) <= w(u, v) + h(v)), like the ones above.
+*
+* Like the DijkstraEngine, it keeps its state in a RoutingContext.
+*/
+class AStarEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** Creates an engine with its own context. */
+    explicit AStarEngine(const CsrGraph& rGraph);
+
+    /** Creates an engine that works on rContext. The context must outlive the engine. */
+    AStarEngine(const CsrGraph& rGraph, RoutingContext& rContext);
+
+    /**
+    * Searches a shortest path from src to dst.
+    * @param rHeuristic provides estimate(node), a lower bound of the distance from node to dst.
+    * @return true, if dst was reached.
+    */
+    template<class H>
+    bool run(tIndex src, tIndex dst, const H& rHeuristic);
+
+    /** Searches with the HaversineHeuristic, for graphs with weights in km. */
+    bool run(tIndex src, tIndex dst) { return run(src, dst, HaversineHeuristic(m_rGraph, dst)); }
+
+    /** @return the distance from the source of the last run, exact for the settled nodes. */
+    double getDistance(tIndex node) const { return m_rContext.getForwardSpace().getDistance(node); }
+
+    /** @return the path of original edges from the source of the last run to dst, empty if unreached. */
+    Graph::tPath getPath(tIndex dst) const { return m_rContext.getForwardSpace().getPath(m_rGraph, dst); }
+
+    /** Writes the path into rPath, which does not allocate if it has the capacity. */
+    void getPath(tIndex dst, Graph::tEdges& rPath) const { m_rContext.getForwardSpace().getPath(m_rGraph, dst, rPath); }
+
+    /** @return the number of nodes that the last run settled, compare with DijkstraEngine. */
+    size_t getNumSettled() const { return m_numSettled; }
+
+
+private:
+
+    const CsrGraph& m_rGraph;
+    std::unique_ptr<RoutingContext> m_pOwnContext;
+    RoutingContext& m_rContext;
+    size_t m_numSettled;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class H>
+bool AStarEngine::run(tIndex src, tIndex dst, const H& rHeuristic)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = m_rContext.getForwardSpace();
+    RoutingContext::tHeap& rHeap = m_rContext.getForwardHeap();
+    rSpace.clear();
+    rHeap.clear();
+    m_numSettled = 0;
+
+    // the heap is ordered by distance + estimate
+    rSpace.update(src, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(rHeuristic.estimate(src), src));
+
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tIndex u = rHeap.back().second;
+        rHeap.pop_back();
+
+        if (rSpace.isSettled(u)) {
+            continue;
+        }
+        rSpace.settle(u);
+        m_numSettled += 1;
+
+        if (u == dst) {
+            return true;
+        }
+
+        double distU = rSpace.getDistance(u);
+        tIndex end = m_rGraph.firstOut(u + 1);
+        for (tIndex e = m_rGraph.firstOut(u); e < end; e++) {
+            tIndex v = m_rGraph.getHead(e);
+            double newDistance = distU + m_rGraph.getWeight(e);
+            if (newDistance < rSpace.getDistance(v)) {
+                rSpace.update(v, newDistance, e);
+                rHeap.push_back(tHeapEntry(newDistance + rHeuristic.estimate(v), v));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef ALTERNATIVEROUTEENGINE_H
+#define ALTERNATIVEROUTEENGINE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Alternative routes with the via-node method.
+*
+* A forward search from the source and a backward search from the target build shortest path
+* trees up to the cost bound of an alternative. Every node v that both trees reach gives the via
+* path source -> v -> target along the trees. A via path is an admissible alternative, if
+* - its cost is at most (1 + maxStretch) times the shortest distance (bounded stretch),
+* - it shares at most maxSharing times the shortest distance with the routes chosen before
+*   (limited sharing),
+* - every subpath of a localOptimality fraction of the shortest distance around v is a shortest
+*   path (local optimality, checked with a T-test).
+*
+* The candidates are ranked by 2 * cost + sharing - plateau, where the plateau of v is the part of
+* the via path on which the two trees agree: a long plateau means that the path is a natural
+* route, not a detour. The sharing with the shortest path and the plateau are computed for all
+* candidates along the trees. All nodes of a plateau give the same via path, so only one of them
+* is a candidate, and only the best candidates are checked exactly.
+*/
+class AlternativeRouteEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** The quality thresholds of an alternative, as fractions of the shortest distance. */
+    struct tOptions
+    {
+        tOptions() : maxAlternatives(3), maxStretch(0.25), maxSharing(0.8), localOptimality(0.25), maxTests(32) { }
+
+        // the number of alternatives besides the shortest path
+        size_t maxAlternatives;
+
+        // an alternative costs at most (1 + maxStretch) times the shortest distance
+        double maxStretch;
+
+        // the length that an alternative shares with the routes chosen before
+        double maxSharing;
+
+        // the subpaths of this length around the via node must be shortest paths
+        double localOptimality;
+
+        // the number of T-tests with a search per query. The candidates whose plateau covers the
+        // subpath of the test need none.
+        size_t maxTests;
+    };
+
+    /** Creates an engine with its own contexts. */
+    explicit AlternativeRouteEngine(const CsrGraph& rGraph, const tOptions& rOptions = tOptions());
+
+    /**
+    * Calculates a shortest path from src to dst and up to maxAlternatives alternatives.
+    * @return the number of routes, 0 if dst is unreachable.
+    */
+    size_t run(tIndex src, tIndex dst);
+
+    /** @return the number of routes of the last run: the shortest path, then the alternatives by rank. */
+    size_t getNumRoutes() const { return m_routes.size(); }
+
+    double getCost(size_t i) const { return m_costs[i]; }
+
+    /** @return the original edges of the i-th route of the last run. */
+    Graph::tPath getPath(size_t i) const;
+
+    /** Writes the original edges of the i-th route of the last run into rPath. */
+    void getPath(size_t i, Graph::tEdges& rPath) const;
+
+    const tOptions& getOptions() const { return m_options; }
+
+
+private:
+
+    /** A via node and its rank. */
+    struct tCandidate
+    {
+        double objective;
+        tIndex node;
+
+        bool operator<(const tCandidate& rOther) const { return objective < rOther.objective; }
+    };
+
+    AlternativeRouteEngine(const AlternativeRouteEngine&);
+    AlternativeRouteEngine& operator=(const AlternativeRouteEngine&);
+
+    /**
+    * Settles the nodes within maxDistance of root in the forward or backward graph.
+    * @param stretchAt if this node is settled, maxDistance becomes (1 + maxStretch) times its distance.
+    * @return the final maxDistance.
+    */
+    double growTree(tIndex root, bool forward, double maxDistance, tIndex stretchAt);
+
+    /** Computes the sharing with the shortest path and the plateau part of the settled nodes of a tree. */
+    void tagTree(bool forward);
+
+    /** Writes the via path through v into rEdges. @return false, if it has a loop. */
+    bool buildViaPath(tIndex v, std::vector<tIndex>& rEdges);
+
+    /**
+    * @return true, if the subpath of the via path around v at viaPosition passes the T-test. The
+    *         test needs no search, if the plateau of v covers the subpath.
+    */
+    bool isLocallyOptimal(const std::vector<tIndex>& rEdges, tIndex v, size_t viaPosition, double distance);
+
+    void accept(const std::vector<tIndex>& rEdges);
+
+    const CsrGraph& m_rGraph;
+    tOptions m_options;
+    RoutingContext m_context;       // the trees, forward and backward
+    RoutingContext m_testContext;   // the T-tests
+
+    // the settled nodes of the forward (0) and backward (1) tree in the order of their distance
+    std::vector<tIndex> m_settled[2];
+
+    // per node, valid for the settled nodes of the trees
+    std::vector<double> m_sharing[2];
+    std::vector<double> m_plateau[2];
+    std::vector<tIndex> m_plateauStart;     // the first node of the plateau, in the forward tree
+
+    // marks the edges and nodes of the chosen routes with m_stamp
+    std::vector<uint32_t> m_onRoute;
+    std::vector<uint32_t> m_nodeOnRoute;
+    uint32_t m_stamp;
+    std::vector<uint32_t> m_visited;    // the nodes of the current via path
+    uint32_t m_visitStamp;
+    size_t m_numTests;
+
+    std::vector<std::vector<tIndex> > m_routes;
+    std::vector<double> m_costs;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
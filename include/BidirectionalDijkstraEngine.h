@@ -0,0 +1,72 @@
+#ifndef BIDIRECTIONALDIJKSTRAENGINE_H
+#define BIDIRECTIONALDIJKSTRAENGINE_H
+
+#include <memory>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Point to point Dijkstra that searches forward from the source over the out-edges and backward
+* from the target over the in-edges at the same time. The side with the smaller heap minimum is
+* advanced, and the search stops as soon as the two minima together reach the length of the
+* best path over a node that both searches have reached. On road networks the two balls
+* together are about half as large as the ball of a unidirectional search.
+*
+* The engine uses the forward and the backward space of a RoutingContext.
+*/
+class BidirectionalDijkstraEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** Creates an engine with its own context. */
+    explicit BidirectionalDijkstraEngine(const CsrGraph& rGraph);
+
+    /** Creates an engine that works on rContext. The context must outlive the engine. */
+    BidirectionalDijkstraEngine(const CsrGraph& rGraph, RoutingContext& rContext);
+
+    /**
+    * Searches a shortest path from src to dst.
+    * @return true, if dst is reachable from src.
+    */
+    bool run(tIndex src, tIndex dst);
+
+    /** @return the length of the path found by the last run or std::numeric_limits<double>::max(). */
+    double getDistance() const { return m_distance; }
+
+    /** @return the node where the forward and the backward path of the last run meet. */
+    tIndex getMeetingNode() const { return m_meetingNode; }
+
+    /** @return the path of original edges found by the last run, empty if there is none. */
+    Graph::tPath getPath() const;
+
+    /** Writes the path of the last run into rPath, which does not allocate if it has the capacity. */
+    void getPath(Graph::tEdges& rPath) const;
+
+    /** @return the number of nodes settled by both searches of the last run. */
+    size_t getNumSettled() const { return m_numSettled; }
+
+
+private:
+
+    /** Settles the next node of one direction and relaxes its out-edges (forward) or in-edges. */
+    void step(bool forward);
+
+    const CsrGraph& m_rGraph;
+    std::unique_ptr<RoutingContext> m_pOwnContext;
+    RoutingContext& m_rContext;
+
+    double m_distance;
+    tIndex m_meetingNode;
+    size_t m_numSettled;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
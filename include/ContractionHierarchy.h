@@ -0,0 +1,211 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <memory>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A Contraction Hierarchy (CH) over a CsrGraph, for fast point to point queries.
+*
+* The preprocessing contracts the nodes one by one in the order of their importance (edge
+* difference plus the number of contracted neighbours, updated lazily). When a node v is
+* contracted, a shortcut u -> w is added for every pair of neighbours, unless a local witness
+* search finds a path from u to w without v that is not longer. The rank of a node is its
+* position in the contraction order.
+*
+* With tOptions::numThreads != 1, every round contracts a set of nodes that are not adjacent and
+* have a lower priority than all of their neighbours. The witness searches of a round run in
+* parallel and avoid all nodes of the set. The shortcuts are collected per thread and merged in
+* the order of the nodes, so the hierarchy does not depend on the number of threads.
+*
+* A query only needs the arcs that lead to higher ranked nodes, which are stored as two compact
+* search graphs: the upward arcs of every node and the downward arcs into every node. Every arc
+* is either an edge of the CsrGraph or a shortcut of two other arcs, so paths can be unpacked
+* into the original edges.
+*/
+class ContractionHierarchy
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** An edge of the hierarchy. For shortcuts, edge is INVALID_INDEX and the children are set. */
+    struct tArc
+    {
+        tIndex tail;
+        tIndex head;
+        double weight;
+        tIndex edge;        // the edge of the CsrGraph
+        tIndex child1;      // shortcuts: the arc from tail to the contracted node
+        tIndex child2;      // shortcuts: the arc from the contracted node to head
+    };
+
+    /** An entry of the search graphs. */
+    struct tSearchArc
+    {
+        tIndex node;        // the head of an upward arc or the tail of a downward arc
+        tIndex arc;
+        double weight;
+    };
+
+    /** Parameters of the preprocessing. */
+    struct tOptions
+    {
+        tOptions() : maxWitnessSettled(500), numThreads(1) { }
+
+        // a witness search gives up after settling this many nodes and adds the shortcut
+        size_t maxWitnessSettled;
+
+        // 1 contracts one node at a time. Otherwise the nodes are contracted in rounds of
+        // independent sets on this many threads (0: one per hardware thread).
+        unsigned numThreads;
+    };
+
+
+public:
+
+    //! @Lifetime
+
+    /** Runs the preprocessing on rGraph. The snapshot must outlive the hierarchy. */
+    explicit ContractionHierarchy(const CsrGraph& rGraph, const tOptions& rOptions = tOptions());
+
+
+    //! @Hierarchy Information
+
+    const CsrGraph& getGraph() const { return m_rGraph; }
+
+    tIndex getNumNodes() const { return m_rGraph.getNumNodes(); }
+
+    /** @return the position of the node in the contraction order, higher ranks are more important. */
+    tIndex getRank(tIndex node) const { return m_rank[node]; }
+
+    /** @return the number of arcs that are shortcuts. */
+    tIndex getNumShortcuts() const { return m_numShortcuts; }
+
+    const tArc& getArc(tIndex arc) const { return m_arcs[arc]; }
+
+    /** The arcs from node to higher ranked nodes are getUp(i) for i in [firstUp(node), firstUp(node + 1)). */
+    tIndex firstUp(tIndex node) const { return m_firstUp[node]; }
+    const tSearchArc& getUp(tIndex i) const { return m_up[i]; }
+
+    /** The arcs from higher ranked nodes into node are getDown(i) for i in [firstDown(node), firstDown(node + 1)). */
+    tIndex firstDown(tIndex node) const { return m_firstDown[node]; }
+    const tSearchArc& getDown(tIndex i) const { return m_down[i]; }
+
+    /** Appends the original edges of an arc (recursively unpacked, if it is a shortcut) to rPath. */
+    void unpackArc(tIndex arc, Graph::tEdges& rPath) const;
+
+    /**
+    * A complete search from root over the upward arcs (forward) or the downward arcs with stall
+    * on demand, in the forward space of rContext.
+    * @param rSettled receives the settled nodes that were not stalled.
+    */
+    void searchUpward(tIndex root, bool forward, RoutingContext& rContext, std::vector<tIndex>& rSettled) const;
+
+
+    //! @Routing
+
+    /**
+    * Finds a shortest path with a CH query. The result has the same length as the one of
+    * Graph::findShortestPathDijkstra.
+    * @throw Graph::InvalidNodeException if a node is not in the snapshot.
+    */
+    Graph::tPath findShortestPath(const Node& rSrc, const Node& rDst) const;
+
+    /** CH query on a reusable context, see CsrGraph::findShortestPathDijkstra for the parameters. */
+    bool findShortestPath(const Node& rSrc, const Node& rDst, RoutingContext& rContext, Graph::tEdges& rPath) const;
+
+    /**
+    * Calculates the distances from all sources to all targets with buckets: an upward search from
+    * every target stores its distance in a bucket at every node it settles, and an upward search
+    * from every source scans the buckets of the nodes it settles. The searches run in parallel.
+    * @param numThreads the number of threads, 0 for one per hardware thread.
+    * @return the row major matrix, see CsrGraph::computeDistanceMatrix.
+    */
+    std::vector<double> computeDistanceMatrix(const std::vector<tIndex>& rSources, const std::vector<tIndex>& rTargets,
+                                              unsigned numThreads = 0) const;
+
+
+private:
+
+    class Contractor;
+
+    const CsrGraph& m_rGraph;
+
+    std::vector<tArc> m_arcs;
+    std::vector<tIndex> m_rank;
+    tIndex m_numShortcuts;
+
+    std::vector<tIndex> m_firstUp;
+    std::vector<tSearchArc> m_up;
+    std::vector<tIndex> m_firstDown;
+    std::vector<tSearchArc> m_down;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The bidirectional query of a ContractionHierarchy: a forward search over the upward arcs from
+* the source and a backward search over the downward arcs from the target. Each side stops when
+* its heap minimum is not better than the best path found so far. Nodes that are reached
+* suboptimally over a higher ranked node are not expanded (stall on demand).
+*
+* The engine keeps its state in the forward and backward space of a RoutingContext.
+*/
+class CHQueryEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** Creates an engine with its own context. */
+    explicit CHQueryEngine(const ContractionHierarchy& rHierarchy);
+
+    /** Creates an engine that works on rContext. The context must outlive the engine. */
+    CHQueryEngine(const ContractionHierarchy& rHierarchy, RoutingContext& rContext);
+
+    /**
+    * Searches a shortest path from src to dst (node indices of the CsrGraph).
+    * @return true, if dst is reachable from src.
+    */
+    bool run(tIndex src, tIndex dst);
+
+    /** @return the length of the path found by the last run or std::numeric_limits<double>::max(). */
+    double getDistance() const { return m_distance; }
+
+    /** @return the path of original edges found by the last run, empty if there is none. */
+    Graph::tPath getPath() const;
+
+    /** Writes the unpacked path of the last run into rPath, which does not allocate if it has the capacity. */
+    void getPath(Graph::tEdges& rPath) const;
+
+    /** @return the number of nodes settled by both searches of the last run. */
+    size_t getNumSettled() const { return m_numSettled; }
+
+
+private:
+
+    /** Settles the next node of one direction and relaxes its upward or downward arcs. */
+    void step(bool forward);
+
+    const ContractionHierarchy& m_rHierarchy;
+    std::unique_ptr<RoutingContext> m_pOwnContext;
+    RoutingContext& m_rContext;
+
+    double m_distance;
+    tIndex m_meetingNode;
+    size_t m_numSettled;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+#include "Graph.h"
+
+class RoutingContext;
+class LandmarkTable;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* An immutable compressed-sparse-row (CSR) snapshot of a Graph for fast routing.
+*
+* The nodes get dense indices 0..n-1 in the id order of the graph. The out-edges of the node
+* with index i are stored in the index range [firstOut(i), firstOut(i + 1)) of the contiguous
+* head and weight arrays, so a relaxation reads neighbouring memory instead of chasing the
+* Edge pointers of every Node. The weights are read once from Edge::getWeight() while the
+* snapshot is built.
+*
+* The snapshot keeps pointers to the original nodes and edges in order to map its results back.
+* It must therefore not outlive its graph and has to be rebuilt after the graph was modified.
+*
+* The const methods only read the snapshot, so several threads may route on it at the same time,
+* each on its own RoutingContext, see QueryExecutor. addMetric must not run concurrently with them.
+*/
+class CsrGraph
+{
+
+public:
+
+    //! @Datatypes
+
+    typedef uint32_t tIndex;
+
+    /** Marks a missing node or edge index, e.g. the predecessor edge of the source node. */
+    static const tIndex INVALID_INDEX = 0xFFFFFFFFu;
+
+    /** The number of a weight column, see addMetric. Metric 0 are the weights of the edges. */
+    typedef uint32_t tMetric;
+
+    /** The result of a single source search in the dense index space of the snapshot. */
+    struct tDistances
+    {
+        std::vector<double> distance;   // std::numeric_limits<double>::max() for unreachable nodes
+        std::vector<tIndex> prevEdge;   // INVALID_INDEX for the source and unreachable nodes
+    };
+
+    /** A path of original edges with its cost, see findKShortestPaths and findAlternativeRoutes. */
+    struct tRoute
+    {
+        double cost;
+        Graph::tPath path;
+    };
+
+    /** An out-edge with its weight in fixed point units, see getFixedArc. */
+    struct tFixedArc
+    {
+        tIndex head;
+        uint32_t weight;
+    };
+
+    /** The part of the graph within a budget around a source, see findReachable. */
+    struct tReachable
+    {
+        std::vector<tIndex> nodes;              // in the order of their distance, starting with the source
+        std::vector<double> distance;           // the distance of every entry of nodes
+        std::vector<tIndex> partialEdges;       // edges from reachable nodes that end beyond the budget
+        std::vector<double> partialFraction;    // the part of every partial edge within the budget, in (0, 1)
+    };
+
+
+public:
+
+    //! @Lifetime
+
+    /**
+    * Compiles the nodes and edges of rGraph. See also Graph::freeze().
+    * @param weightUnit if > 0, the weights are also stored as 32 bit multiples of this unit,
+    *        rounded to the nearest one, e.g. 1e-3 for meters with km weights. See FixedPointDijkstraEngine.
+    * @throw Graph::Exception if a weight is negative or does not fit into 32 bits, choose a larger unit then.
+    */
+    explicit CsrGraph(Graph& rGraph, double weightUnit = 0.0);
+
+
+    //! @Graph Information
+
+    tIndex getNumNodes() const { return static_cast<tIndex>(m_nodes.size()); }
+    tIndex getNumEdges() const { return static_cast<tIndex>(m_head.size()); }
+
+    /** The first out-edge of the node. The out-edges of node end at firstOut(node + 1). */
+    tIndex firstOut(tIndex node) const { return m_firstOut[node]; }
+
+    /** The first in-edge of the node in the backward adjacency, see getInEdge. */
+    tIndex firstIn(tIndex node) const { return m_firstIn[node]; }
+
+    /**
+    * The backward adjacency lists the in-edges of every node: the in-edges of node are
+    * getInEdge(i) for i in [firstIn(node), firstIn(node + 1)). They are returned as edge indices
+    * of the forward arrays, so getTail, getWeight and getEdge apply to them.
+    */
+    tIndex getInEdge(tIndex i) const { return m_inEdge[i]; }
+
+    /** The node index of the destination of the edge. */
+    tIndex getHead(tIndex edge) const { return m_head[edge]; }
+
+    /** The node index of the source of the edge. */
+    tIndex getTail(tIndex edge) const { return m_tail[edge]; }
+
+    double getWeight(tIndex edge) const { return m_weight[edge]; }
+
+    /** @return the weight of the edge in a metric, see addMetric. */
+    double getWeight(tIndex edge, tMetric metric) const { return getWeights(metric)[edge]; }
+
+    /** @return the weight column of a metric, indexed by edge. */
+    const double* getWeights(tMetric metric) const { return metric == 0 ? m_weight.data() : m_metrics[metric - 1].data(); }
+
+    /**
+    * Adds a weight column, e.g. the travel time of a truck, so that the same snapshot can be routed
+    * with several metrics. A column costs 8 bytes per edge, a copy of the graph far more.
+    * @param weights the weight of every edge, indexed like the edges of the snapshot.
+    * @return the number of the new metric.
+    * @throw Graph::Exception if there is not one non-negative weight per edge.
+    */
+    tMetric addMetric(const std::string& rName, std::vector<double> weights);
+
+    /**
+    * Adds a weight column that weightOf(edge index) computes once per edge, e.g. from the
+    * attributes of getEdge(edge). See addMetric above.
+    */
+    template<class F>
+    tMetric addMetric(const std::string& rName, F weightOf);
+
+    tMetric getNumMetrics() const { return static_cast<tMetric>(m_metrics.size() + 1); }
+
+    /** @return the name of the metric, "weight" for metric 0. */
+    const std::string& getMetricName(tMetric metric) const { return m_metricNames[metric]; }
+
+    /** @return the number of the metric with the given name or getNumMetrics(), if there is none. */
+    tMetric findMetric(const std::string& rName) const;
+
+    /** @return true, if the snapshot was compiled with a weight unit. */
+    bool hasFixedWeights() const { return m_weightUnit > 0.0; }
+
+    /** @return the unit of the fixed point weights, 0 if there are none. */
+    double getWeightUnit() const { return m_weightUnit; }
+
+    /**
+    * The head and the fixed point weight of the edge in one 8 byte entry, so a relaxation reads
+    * less memory than with getHead and getWeight. Only valid if hasFixedWeights().
+    */
+    const tFixedArc& getFixedArc(tIndex edge) const { return m_fixedArc[edge]; }
+
+    /** The coordinates of the node, copied from Node::getLon() / Node::getLat(). */
+    double getLon(tIndex node) const { return m_lon[node]; }
+    double getLat(tIndex node) const { return m_lat[node]; }
+
+    Node* getNode(tIndex node) const { return m_nodes[node]; }
+    Edge* getEdge(tIndex edge) const { return m_edges[edge]; }
+
+    /**
+    * Retrieves the dense index of a node of the graph.
+    * @throw Graph::InvalidNodeException if the node is not part of the snapshot.
+    */
+    tIndex getIndex(const Node& rNode) const;
+
+    /** @return the dense index of the node with the given id or INVALID_INDEX if not found. */
+    tIndex findIndexById(const std::string& id) const;
+
+
+    //! @Routing
+
+    /**
+    * The Dijkstra algorithm on the snapshot, see Graph::findDistancesDijkstraV1.
+    * @param src is the node index to calculate the distances from.
+    * @param dst the algorithm stops, if the path to dst is found. Pass INVALID_INDEX for a full tree.
+    * @return the distances and predecessor edges of all nodes.
+    */
+    tDistances findDistancesDijkstra(tIndex src, tIndex dst = INVALID_INDEX) const;
+
+    /**
+    * Calculate the shortest path from a source node to a destination node.
+    * The result is the same as the one of Graph::findShortestPathDijkstra.
+    * @return a deque of the original edges from rSrc to rDst, empty if there is no path.
+    */
+    Graph::tPath findShortestPathDijkstra(const Node& rSrc, const Node& rDst) const;
+
+    /** Calculate the shortest path like above, but for the weights of a metric, see addMetric. */
+    Graph::tPath findShortestPathDijkstra(const Node& rSrc, const Node& rDst, tMetric metric) const;
+
+    /**
+    * Calculate the shortest path like above, but on a reusable (e.g. per thread) context.
+    * Repeated queries do not allocate, once the context and rPath have grown large enough.
+    * @param rPath receives the original edges from rSrc to rDst, empty if there is no path.
+    * @return true, if a path was found.
+    */
+    bool findShortestPathDijkstra(const Node& rSrc, const Node& rDst,
+                                  RoutingContext& rContext, Graph::tEdges& rPath) const;
+
+    /**
+    * Calculate the shortest path with an A* search, which is guided by the great circle distance
+    * to rDst. This requires weights in km like the ones of GeoJSONGraphConverter, see AStarEngine
+    * for other weights. The search settles far fewer nodes than findShortestPathDijkstra.
+    * @return a deque of the original edges from rSrc to rDst, empty if there is no path.
+    */
+    Graph::tPath findShortestPathAStar(const Node& rSrc, const Node& rDst) const;
+
+    /** A* search on a reusable context, see findShortestPathDijkstra for the parameters. */
+    bool findShortestPathAStar(const Node& rSrc, const Node& rDst,
+                               RoutingContext& rContext, Graph::tEdges& rPath) const;
+
+    /**
+    * Calculate the shortest path with a bidirectional Dijkstra search, see BidirectionalDijkstraEngine.
+    * @return a deque of the original edges from rSrc to rDst, empty if there is no path.
+    */
+    Graph::tPath findShortestPathBidirectional(const Node& rSrc, const Node& rDst) const;
+
+    /** Bidirectional search on a reusable context, see findShortestPathDijkstra for the parameters. */
+    bool findShortestPathBidirectional(const Node& rSrc, const Node& rDst,
+                                       RoutingContext& rContext, Graph::tEdges& rPath) const;
+
+    /**
+    * Calculate the shortest path with ALT: an A* search with the landmark bounds of rLandmarks,
+    * which must have been computed on this snapshot or an earlier one of the same graph.
+    * @return a deque of the original edges from rSrc to rDst, empty if there is no path.
+    */
+    Graph::tPath findShortestPathALT(const Node& rSrc, const Node& rDst, const LandmarkTable& rLandmarks) const;
+
+    /** ALT search on a reusable context, see findShortestPathDijkstra for the parameters. */
+    bool findShortestPathALT(const Node& rSrc, const Node& rDst, const LandmarkTable& rLandmarks,
+                             RoutingContext& rContext, Graph::tEdges& rPath) const;
+
+    /**
+    * Calculates the k shortest loopless paths from rSrc to rDst, see YenEngine.
+    * @param numThreads the number of threads for the spur searches, 0 for one per hardware thread.
+    * @return up to k routes sorted by cost, the first one is a shortest path.
+    */
+    std::vector<tRoute> findKShortestPaths(const Node& rSrc, const Node& rDst, size_t k, unsigned numThreads = 0) const;
+
+    /**
+    * Calculates a shortest path and meaningfully different alternatives with the default quality
+    * thresholds of AlternativeRouteEngine, which also takes other thresholds.
+    * @return the shortest path first and then up to maxAlternatives alternatives, empty if there is no path.
+    */
+    std::vector<tRoute> findAlternativeRoutes(const Node& rSrc, const Node& rDst, size_t maxAlternatives = 3) const;
+
+    /**
+    * Calculates the distances from all sources to all targets with one Dijkstra per source, which
+    * stops when all targets are settled. The searches run in parallel.
+    * See ContractionHierarchy::computeDistanceMatrix for a faster version on large graphs.
+    * @param numThreads the number of threads, 0 for one per hardware thread.
+    * @return the row major matrix: entry i * rTargets.size() + j is the distance from rSources[i]
+    *         to rTargets[j] or std::numeric_limits<double>::max(), if there is no path.
+    */
+    std::vector<double> computeDistanceMatrix(const std::vector<tIndex>& rSources, const std::vector<tIndex>& rTargets,
+                                              unsigned numThreads = 0) const;
+
+    /**
+    * Calculates the nodes within a budget around rSrc with a bounded Dijkstra search, which only
+    * touches the reachable part of the graph, e.g. for isochrones. See also
+    * GeoJSONGraphConverter::toIsochrone.
+    * @param maxCost the budget in the unit of the weights.
+    * @return the reachable nodes and the partially traversed edges at the border of the budget.
+    */
+    tReachable findReachable(const Node& rSrc, double maxCost) const;
+
+    /**
+    * Like findReachable above, but on a reusable context and result, which do not allocate, once
+    * they have grown large enough.
+    */
+    void findReachable(const Node& rSrc, double maxCost, RoutingContext& rContext, tReachable& rReachable) const;
+
+    /** Unwinds the predecessor edges of a search result from dst back to the source. */
+    Graph::tPath unpackPath(const tDistances& rDistances, tIndex dst) const;
+
+
+private:
+
+    std::vector<tIndex> m_firstOut;     // n + 1 entries
+    std::vector<tIndex> m_head;         // m entries
+    std::vector<tIndex> m_tail;         // m entries
+    std::vector<double> m_weight;       // m entries
+    std::vector<tFixedArc> m_fixedArc;  // m entries, if compiled with a weight unit
+    double m_weightUnit;
+    std::vector<std::vector<double> > m_metrics;    // a column of m entries per metric from 1 on
+    std::vector<std::string> m_metricNames;         // per metric from 0 on
+    std::vector<tIndex> m_firstIn;      // n + 1 entries
+    std::vector<tIndex> m_inEdge;       // m entries, forward edge indices grouped by head
+    std::vector<double> m_lon;          // n entries
+    std::vector<double> m_lat;          // n entries
+
+    std::vector<Node*> m_nodes;         // index -> node
+    std::vector<Edge*> m_edges;         // index -> edge
+    std::unordered_map<const Node*, tIndex> m_indexByNode;
+
+    Graph* m_pGraph;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class F>
+CsrGraph::tMetric CsrGraph::addMetric(const std::string& rName, F weightOf)
+{
+    std::vector<double> weights(getNumEdges());
+    for (tIndex e = 0; e < getNumEdges(); e++) {
+        weights[e] = weightOf(e);
+    }
+    return addMetric(rName, std::move(weights));
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
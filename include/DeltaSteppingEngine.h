@@ -0,0 +1,76 @@
+#ifndef DELTASTEPPINGENGINE_H
+#define DELTASTEPPINGENGINE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Parallel one to all distances with delta-stepping.
+*
+* The tentative distances are sorted into buckets of width delta. All nodes of the current bucket
+* are relaxed in parallel, and every thread collects the nodes that it improves in buckets of its
+* own, so that no locks are needed. The nodes of a bucket are handed out to the threads in small
+* chunks, which balances the load. A bucket is processed again until it stays empty, so the
+* distances are exactly the ones of Dijkstra's algorithm (the search is label correcting, and the
+* floating point sums along the paths are the same).
+*
+* A small delta approaches Dijkstra's algorithm with little parallelism, a large one approaches
+* Bellman-Ford with a lot of redundant relaxations.
+*/
+class DeltaSteppingEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /**
+    * Creates an engine with its own threads.
+    * @param delta the bucket width, 0 for the mean edge weight times the mean out degree.
+    * @param numThreads 0 uses one thread per hardware thread.
+    */
+    explicit DeltaSteppingEngine(const CsrGraph& rGraph, double delta = 0.0, unsigned numThreads = 0);
+
+    /** Calculates the distances from src to all nodes. */
+    void run(tIndex src);
+
+    /** @return the distance from the source of the last run or std::numeric_limits<double>::max(). */
+    double getDistance(tIndex node) const { return m_distances[node].load(std::memory_order_relaxed); }
+
+    /** Writes the distances of the last run into rDistances, indexed by node. */
+    void getDistances(std::vector<double>& rDistances) const;
+
+    double getDelta() const { return m_delta; }
+    unsigned getNumThreads() const { return m_pool.getNumThreads(); }
+
+    /** @return the number of bucket phases of the last run. */
+    size_t getNumPhases() const { return m_numPhases; }
+
+
+private:
+
+    DeltaSteppingEngine(const DeltaSteppingEngine&);
+    DeltaSteppingEngine& operator=(const DeltaSteppingEngine&);
+
+    const CsrGraph& m_rGraph;
+    ThreadPool m_pool;
+    double m_delta;
+
+    std::unique_ptr<std::atomic<double>[]> m_distances;
+
+    // the buckets of every thread, indexed by bucket number: the nodes that the thread improved
+    std::vector<std::vector<std::vector<tIndex> > > m_buckets;
+    std::vector<tIndex> m_frontier;
+    size_t m_numPhases;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef DIJKSTRAENGINE_H
+#define DIJKSTRAENGINE_H
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The weights of a metric of a CsrGraph as functor for DijkstraEngine::run, see CsrGraph::addMetric.
+* A functor maps an edge index to its weight. It is inlined into the relaxation.
+*/
+class MetricWeight
+{
+public:
+
+    explicit MetricWeight(const CsrGraph& rGraph, CsrGraph::tMetric metric = 0) : m_pWeights(rGraph.getWeights(metric)) { }
+
+    double operator()(CsrGraph::tIndex edge) const { return m_pWeights[edge]; }
+
+private:
+
+    const double* m_pWeights;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Dijkstra's algorithm on a CsrGraph with a binary heap and a dense SearchSpace.
+*
+* All search state lives in a RoutingContext. Either the engine owns one, or it works on a
+* context that is passed in, e.g. a per thread context that is shared with other engines. An
+* engine is cheap to construct on a sized context, and a query only touches the nodes that it
+* reaches, so short queries on large graphs are fast and do not allocate.
+*/
+class DijkstraEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** Creates an engine with its own context. */
+    explicit DijkstraEngine(const CsrGraph& rGraph);
+
+    /** Creates an engine that works on rContext. The context must outlive the engine. */
+    DijkstraEngine(const CsrGraph& rGraph, RoutingContext& rContext);
+
+    /**
+    * Calculates the shortest paths from src.
+    * @param dst the search stops, when dst is settled. Pass INVALID_INDEX for a full tree.
+    * @return true, if dst was reached (always false for a full tree).
+    */
+    bool run(tIndex src, tIndex dst = CsrGraph::INVALID_INDEX);
+
+    /**
+    * Like run above with other weights: weightOf(edge) returns the weight of an edge index, e.g.
+    * MetricWeight for another metric of the graph or a lambda. The same engine and context serve
+    * all metrics.
+    */
+    template <class tWeight>
+    bool run(tIndex src, tIndex dst, const tWeight& weightOf);
+
+    /**
+    * Calculates the shortest paths from src until numTargets (> 0) nodes are settled that are
+    * marked in rIsTarget, which is indexed by node.
+    * @return true, if all targets were reached.
+    */
+    bool run(tIndex src, const std::vector<char>& rIsTarget, size_t numTargets);
+
+    /**
+    * Settles exactly the nodes with a distance of at most maxDistance from src. Nodes beyond the
+    * budget are neither settled nor reached.
+    * @param rSettled receives the settled nodes in the order of their distance, starting with src.
+    */
+    void runWithin(tIndex src, double maxDistance, std::vector<tIndex>& rSettled);
+
+    /**
+    * Calculates the shortest paths from src to all nodes with another priority queue, see
+    * PriorityQueues.h. The queue keeps its buffers for the next run. With the integer key queues,
+    * getNumSettled() also counts the nodes that are relaxed a second time.
+    */
+    template <class tQueue>
+    void run(tIndex src, tQueue& rQueue);
+
+    /** @return the distance from the source of the last run or std::numeric_limits<double>::max(). */
+    double getDistance(tIndex node) const { return m_rContext.getForwardSpace().getDistance(node); }
+
+    /** @return the path of original edges from the source of the last run to dst, empty if unreached. */
+    Graph::tPath getPath(tIndex dst) const;
+
+    /**
+    * Writes the path of original edges from the source of the last run to dst into rPath.
+    * This does not allocate, if rPath has enough capacity from earlier queries.
+    */
+    void getPath(tIndex dst, Graph::tEdges& rPath) const;
+
+    /** @return the number of nodes that the last run settled, a measure for its search space. */
+    size_t getNumSettled() const { return m_numSettled; }
+
+    const SearchSpace& getSearchSpace() const { return m_rContext.getForwardSpace(); }
+    const CsrGraph& getGraph() const { return m_rGraph; }
+
+
+private:
+
+    /**
+    * Dijkstra from src over the nodes within maxDistance, until onSettle(node) returns true for a
+    * settled node.
+    * @return true, if the search was stopped by onSettle.
+    */
+    template <class tOnSettle, class tWeight>
+    bool search(tIndex src, double maxDistance, tOnSettle onSettle, const tWeight& weightOf);
+
+    const CsrGraph& m_rGraph;
+    std::unique_ptr<RoutingContext> m_pOwnContext;
+    RoutingContext& m_rContext;
+    size_t m_numSettled;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template <class tWeight>
+bool DijkstraEngine::run(tIndex src, tIndex dst, const tWeight& weightOf)
+{
+    return search(src, std::numeric_limits<double>::max(), [dst](tIndex node) { return node == dst; }, weightOf);
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template <class tOnSettle, class tWeight>
+bool DijkstraEngine::search(tIndex src, double maxDistance, tOnSettle onSettle, const tWeight& weightOf)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = m_rContext.getForwardSpace();
+    RoutingContext::tHeap& rHeap = m_rContext.getForwardHeap();
+    rSpace.clear();
+    rHeap.clear();
+    m_numSettled = 0;
+
+    rSpace.update(src, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(0.0, src));
+
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tIndex u = rHeap.back().second;
+        rHeap.pop_back();
+
+        // skip outdated heap entries
+        if (rSpace.isSettled(u)) {
+            continue;
+        }
+        rSpace.settle(u);
+        m_numSettled += 1;
+
+        if (onSettle(u)) {
+            return true;
+        }
+
+        double distU = rSpace.getDistance(u);
+        tIndex end = m_rGraph.firstOut(u + 1);
+        for (tIndex e = m_rGraph.firstOut(u); e < end; e++) {
+            tIndex v = m_rGraph.getHead(e);
+            double newDistance = distU + weightOf(e);
+            if (newDistance < rSpace.getDistance(v) && newDistance <= maxDistance) {
+                rSpace.update(v, newDistance, e);
+                rHeap.push_back(tHeapEntry(newDistance, v));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template <class tQueue>
+void DijkstraEngine::run(tIndex src, tQueue& rQueue)
+{
+    SearchSpace& rSpace = m_rContext.getForwardSpace();
+    rSpace.clear();
+    rQueue.reserve(m_rGraph.getNumNodes());
+    rQueue.clear();
+    m_numSettled = 0;
+
+    rSpace.update(src, 0.0, CsrGraph::INVALID_INDEX);
+    rQueue.push(src, 0.0);
+
+    while (!rQueue.empty()) {
+        typename tQueue::tHeapEntry top = rQueue.pop();
+        tIndex u = top.second;
+
+        // skip outdated entries. A queue that returns equal integer keys in any order may bring
+        // a node here again with a lower distance, then it is relaxed again.
+        double distU = rSpace.getDistance(u);
+        if (top.first > distU) {
+            continue;
+        }
+        rSpace.settle(u);
+        m_numSettled += 1;
+
+        tIndex end = m_rGraph.firstOut(u + 1);
+        for (tIndex e = m_rGraph.firstOut(u); e < end; e++) {
+            tIndex v = m_rGraph.getHead(e);
+            double newDistance = distU + m_rGraph.getWeight(e);
+            if (newDistance < rSpace.getDistance(v)) {
+                rSpace.update(v, newDistance, e);
+                rQueue.push(v, newDistance);
+            }
+        }
+    }
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
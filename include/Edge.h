@@ -2,6 +2,7 @@
 #define EDGE_H
 
 #include <string>
+#include <cstdint>
 #include "Node.h"
 
 
@@ -41,6 +42,10 @@ private:
 	Node& m_srcNode;
 	Node& m_dstNode;
 
+	// positions of this edge in m_srcNode.m_outEdges and m_dstNode.m_inEdges
+	uint32_t m_outPos;
+	uint32_t m_inPos;
+
 #ifdef TESTING
     friend class GraphTesting;
 #endif
@@ -0,0 +1,159 @@
+#ifndef FIXEDPOINTDIJKSTRAENGINE_H
+#define FIXEDPOINTDIJKSTRAENGINE_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "PriorityQueues.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Dijkstra's algorithm on the fixed point weights of a CsrGraph, which was compiled with a weight
+* unit (see Graph::freeze).
+*
+* The relaxation reads the head and the 32 bit weight of an edge from one 8 byte CsrGraph::tFixedArc
+* instead of a 4 byte head and an 8 byte double. The distances are summed up as 64 bit integers,
+* which cannot overflow, and are exact: getDistance returns the sum of the rounded weights times
+* the unit. The keys are integers, so the default queue is a RadixHeapQueue, which needs no
+* comparisons.
+*
+* The paths are shortest paths for the rounded weights. They may differ from the ones of the
+* DijkstraEngine, if paths differ in cost by less than the rounding error.
+*/
+class FixedPointDijkstraEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** A distance in units of the weights. */
+    typedef uint64_t tDistance;
+
+    static const tDistance INFINITE_DISTANCE = 0xFFFFFFFFFFFFFFFFull;
+
+    /**
+    * Creates an engine with its own search space.
+    * @throw Graph::Exception if rGraph has no fixed point weights.
+    */
+    explicit FixedPointDijkstraEngine(const CsrGraph& rGraph);
+
+    /**
+    * Calculates the shortest paths from src.
+    * @param dst the search stops, when dst is settled. Pass INVALID_INDEX for a full tree.
+    * @return true, if dst was reached (always false for a full tree).
+    */
+    bool run(tIndex src, tIndex dst = CsrGraph::INVALID_INDEX) { return run(src, dst, m_queue); }
+
+    /**
+    * Like run above with another queue policy, see PriorityQueues.h. The keys are the distances
+    * in units, so a RadixHeapQueue needs a scale of 1.
+    */
+    template <class tQueue>
+    bool run(tIndex src, tIndex dst, tQueue& rQueue);
+
+    /** @return the distance from the source of the last run in units or INFINITE_DISTANCE. */
+    tDistance getFixedDistance(tIndex node) const {
+        return m_entries[node].stamp >= m_round ? m_entries[node].distance : INFINITE_DISTANCE;
+    }
+
+    /** @return the distance from the source of the last run or std::numeric_limits<double>::max(). */
+    double getDistance(tIndex node) const {
+        tDistance distance = getFixedDistance(node);
+        return distance == INFINITE_DISTANCE ? std::numeric_limits<double>::max() : distance * m_rGraph.getWeightUnit();
+    }
+
+    /** @return the path of original edges from the source of the last run to dst, empty if unreached. */
+    Graph::tPath getPath(tIndex dst) const;
+
+    /** Writes the path into rPath, which does not allocate if it has the capacity. */
+    void getPath(tIndex dst, Graph::tEdges& rPath) const;
+
+    /** @return the number of nodes that the last run settled. */
+    size_t getNumSettled() const { return m_numSettled; }
+
+    const CsrGraph& getGraph() const { return m_rGraph; }
+
+
+private:
+
+    // like the entries of a SearchSpace, with a stamp per search
+    struct tEntry
+    {
+        tDistance distance;
+        tIndex prevEdge;
+        uint32_t stamp;     // < m_round: unreached, m_round: reached, m_round + 1: settled
+    };
+
+    /** Starts a new search: all nodes become unreached. */
+    void clear();
+
+    tIndex getPrevEdge(tIndex node) const {
+        return m_entries[node].stamp >= m_round ? m_entries[node].prevEdge : CsrGraph::INVALID_INDEX;
+    }
+
+    const CsrGraph& m_rGraph;
+    std::vector<tEntry> m_entries;
+    uint32_t m_round;
+    RadixHeapQueue m_queue;
+    size_t m_numSettled;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template <class tQueue>
+bool FixedPointDijkstraEngine::run(tIndex src, tIndex dst, tQueue& rQueue)
+{
+    clear();
+    rQueue.reserve(m_rGraph.getNumNodes());
+    rQueue.clear();
+    m_numSettled = 0;
+
+    // the queue keys are the distances in units, which doubles represent exactly below 2^53
+    m_entries[src].distance = 0;
+    m_entries[src].prevEdge = CsrGraph::INVALID_INDEX;
+    m_entries[src].stamp = m_round;
+    rQueue.push(src, 0.0);
+
+    while (!rQueue.empty()) {
+        typename tQueue::tHeapEntry top = rQueue.pop();
+        tIndex u = top.second;
+        tEntry& rEntry = m_entries[u];
+        if (rEntry.stamp == m_round + 1 || top.first > static_cast<double>(rEntry.distance)) {
+            continue;
+        }
+        rEntry.stamp = m_round + 1;
+        m_numSettled += 1;
+
+        if (u == dst) {
+            return true;
+        }
+
+        tDistance distU = rEntry.distance;
+        tIndex end = m_rGraph.firstOut(u + 1);
+        for (tIndex e = m_rGraph.firstOut(u); e < end; e++) {
+            const CsrGraph::tFixedArc& rArc = m_rGraph.getFixedArc(e);
+            tDistance newDistance = distU + rArc.weight;
+            tEntry& rHead = m_entries[rArc.head];
+            if (rHead.stamp < m_round) {
+                rHead.stamp = m_round;
+            } else if (newDistance >= rHead.distance) {
+                continue;
+            }
+            rHead.distance = newDistance;
+            rHead.prevEdge = e;
+            rQueue.push(rArc.head, static_cast<double>(newDistance));
+        }
+    }
+
+    return false;
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
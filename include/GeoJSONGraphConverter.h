@@ -2,7 +2,10 @@
 #define GEOJSONGRAPHCONVERTER_H
 
 #include <string>
+#include <utility>
+#include <vector>
 #include "Graph.h"
+#include "CsrGraph.h"
 #include "json.hpp"
 
 class GeoJSONGraphConverter {
@@ -10,12 +13,19 @@ public:
     // 将GeoJSON字符串转换为Graph对象
     static int fromGeoJSON(Graph & graph,const std::string& geojson);
 
+    // 将CsrGraph::findReachable的结果转换为等时圈的GeoJSON Feature(凹包多边形)
+    // 顶点是可达节点和部分通过的边的终点; concavity越小多边形越贴近这些点, 很大时得到凸包
+    static std::string toIsochrone(const CsrGraph& graph, const CsrGraph::tReachable& reachable, double concavity = 2.0);
+
 private:
     // 计算两点间的Haversine距离(单位:公里)
     static double haversineDistance(double lon1, double lat1, double lon2, double lat2);
     
     // 根据坐标生成唯一节点ID
     static std::string generateNodeId(double lon, double lat);
+
+    // 计算平面点集的凹包, 返回逆时针顺序的点索引
+    static std::vector<size_t> concaveHull(const std::vector<std::pair<double, double> >& points, double concavity);
 };
 
 #endif // GEOJSONGRAPHCONVERTER_H
\ No newline at end of file
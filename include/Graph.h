@@ -8,18 +8,26 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <queue>
+#include <unordered_set>
 
 #include "Node.h"
 #include "Edge.h"
 #include "SimpleEdge.h"
+#include "NodeIndex.h"
+#include "ObjectArena.h"
+
+class CsrGraph;
 
 /* --------------------------------------------------------------------------------------------- */
 
 class Graph
 {
 
-private:
+public:
 
     //! @Datataypes
 
@@ -68,18 +76,39 @@ public:
     T& makeNode(Args&&... args) { return makeNode(T(std::forward<Args>(args)...)); }
 
     template<class T>
-    T& makeEdge(T&& edge);
+    T& makeEdge(T&& edge) { return constructEdge<T>(true, std::move(edge)); }
 
+    /** Constructs the edge in place from the given arguments. */
     template<class T, class... Args>
-    T& makeEdge(Args&&... args) { return makeEdge(T(std::forward<Args>(args)...)); }
+    T& makeEdge(Args&&... args) { return constructEdge<T>(true, std::forward<Args>(args)...); }
 
     /** Constructs to Edges. */
     template<class T, class... Args>
     void makeBiEdge(Node& n1, Node& n2, Args&&... args) { 
-        makeEdge(T(n1, n2, std::forward<Args>(args)...));
-        makeEdge(T(n2, n1, std::forward<Args>(args)...));
+        constructEdge<T>(true, n1, n2, args...);
+        constructEdge<T>(true, n2, n1, args...);
     }
 
+    /**
+    * Makes an edge without checking that its nodes belong to this graph.
+    * This is the trusted bulk insertion path for loaders, which take the nodes from this graph.
+    */
+    template<class T>
+    T& makeEdgeUnchecked(T&& edge) { return constructEdge<T>(false, std::move(edge)); }
+
+    template<class T, class... Args>
+    T& makeEdgeUnchecked(Args&&... args) { return constructEdge<T>(false, std::forward<Args>(args)...); }
+
+    /** Constructs two edges without checking the nodes, see makeEdgeUnchecked. */
+    template<class T, class... Args>
+    void makeBiEdgeUnchecked(Node& n1, Node& n2, Args&&... args) {
+        constructEdge<T>(false, n1, n2, args...);
+        constructEdge<T>(false, n2, n1, args...);
+    }
+
+    /** Prepares the node id index for numNodes nodes, in order to avoid rehashing while loading. */
+    void reserveNodes(size_t numNodes) { m_nodeIndex.reserve(numNodes); }
+
     template<class T>
     Graph& operator << (T&& rEdge) {
         // forward as r-value reference
@@ -90,6 +119,9 @@ public:
     tNodePtrSet& getNodes() { return m_nodes; }
     tEdgePtrList& getEdges() { return m_edges; }
 
+    /** @return true, if rNode is a node of this graph. The check takes constant time. */
+    bool contains(const Node& rNode) const { return rNode.m_owner.pGraph == this; }
+
     /**
     * Deletes the given Edge from the graph.
     * The Edge object will be destroyed after this function call.
@@ -106,10 +138,13 @@ public:
     bool remove(const Node& rNode);
 
     /** 
-    * Retrieves a node by the given id. 
+    * Retrieves a node by the given id in constant time.
+    * The overloads for character ranges do not allocate a temporary std::string.
     * @return a pointer to the node or NULL if not found. 
     */
-    Node* findNodeById(const std::string& id);
+    Node* findNodeById(const std::string& id) { return m_nodeIndex.find(id); }
+    Node* findNodeById(const char* id) { return m_nodeIndex.find(id); }
+    Node* findNodeById(const char* id, size_t length) { return m_nodeIndex.find(id, length); }
 
     /** Retrieves all edges that have rSrc as source node and rDst as destination node. */
     tEdges findEdges(const Node& rSrc, const Node& rDst);
@@ -147,6 +182,20 @@ public:
     */
     tDijkstraMap findDistancesDijkstraV1(const Node& rSrcNode, const Node* pDstNode, Node** pFoundDst);
 
+    /**
+    * Like findDistancesDijkstraV1 above for a graph whose edges all have exactly the type T. The
+    * weights are read with a non-virtual call of T::getWeight(), which the compiler can inline.
+    * The version above does this by itself for graphs of SimpleEdges only, like the ones of
+    * GeoJSONGraphConverter, and calls the virtual Edge::getWeight() for other graphs.
+    * @throw Exception if the graph has an edge of another type.
+    */
+    template<class T>
+    tDijkstraMap findDistancesDijkstraV1(const Node& rSrcNode, const Node* pDstNode, Node** pFoundDst);
+
+    /** @return true, if all edges of the graph have exactly the type T (and not a subclass of it). */
+    template<class T>
+    bool hasOnlyEdgesOf() const { return m_arena.count<T>() == m_edges.size(); }
+
 
     /**
     * Calculate the shortest path from a source node to a destination node.
@@ -156,12 +205,50 @@ public:
     */
     tPath findShortestPathDijkstra(const Node& rSrc, const Node& rDst, bool useV1=false);
 
+    /**
+    * Compiles the current nodes and edges into an immutable CsrGraph routing snapshot.
+    * The snapshot refers to the nodes and edges of this graph, so it must be rebuilt
+    * after the graph was modified and must not outlive it.
+    * @param weightUnit if > 0, the snapshot also stores fixed point weights, see CsrGraph.
+    */
+    CsrGraph freeze(double weightUnit = 0.0);
+
 
 protected:
 
+    /** Deletes all nodes and edges. */
+    void deleteAll();
+
+    /** Constructs an edge of type T in the graph, optionally checking that its nodes belong to it. */
+    template<class T, class... Args>
+    T& constructEdge(bool checkNodes, Args&&... args);
+
+    /** The search of findDistancesDijkstraV1, which reads the weights with getWeight<T>. */
+    template<class T>
+    tDijkstraMap runDijkstraV1(const Node& rSrcNode, const Node* pDstNode, Node** pFoundDst);
+
+    /** @return the weight of an edge of exactly the type T without a virtual call, see getWeight<Edge>. */
+    template<class T>
+    static double getWeight(Edge* pEdge) { return static_cast<T*>(pEdge)->T::getWeight(); }
+
+    // the entries of the priority queue of findDistancesDijkstraV1
+    typedef std::pair<Node*, double> tHeapEntry;
+    struct CompareDist {
+        bool operator()(const tHeapEntry& lhs, const tHeapEntry& rhs) const {
+            return lhs.second > rhs.second;  // 最小堆：距离小的优先
+        }
+    };
+
+    // Nodes and edges are allocated in per-type slabs and freed in bulk with the graph.
+    // It is declared before the containers, so that it is destroyed after them.
+    ObjectArena m_arena;
+
     tNodePtrSet m_nodes;
     tEdgePtrList m_edges;
 
+    // hash index by id over the nodes in m_nodes
+    NodeIndex m_nodeIndex;
+
 #ifdef TESTING
     friend class GraphTesting;
 #endif
@@ -200,37 +287,129 @@ template<class T>
 T& Graph::makeNode(T&& node)
 {
     // is there already a node with the given id?
-    auto it = m_nodes.lower_bound(&node);
-    if (it != m_nodes.end() && (*it)->getId() == node.getId()) {
+    if (m_nodeIndex.find(node.getId()) != NULL) {
         throw NodeCreationException("NodeID is not unique: " + node.getId());
     }
 
     // if not, create a new node
-    auto ret = m_nodes.insert(it, new T(std::move(node)));
+    T* newNode = m_arena.create<T>(std::move(node));
+    newNode->m_owner.pGraph = this;
+    m_nodes.insert(newNode);
+    m_nodeIndex.insert(newNode);
+    return *newNode;
+}
+
 
-    // ret.first is an iterator to the new element. 
-    // We must dereference it twice (iterator & unique_ptr) in order to get the node reference.
-    return **ret;
+/* --------------------------------------------------------------------------------------------- */
+
+template<class T, class... Args>
+T& Graph::constructEdge(bool checkNodes, Args&&... args)
+{
+    // The edge is constructed directly in the arena, so that it is added to the adjacency of
+    // its nodes only once, without a temporary.
+    T* newEdge = m_arena.create<T>(std::forward<Args>(args)...);
+
+    // check if src and destination nodes are in the graph
+    if (checkNodes && !(contains(newEdge->getSrcNode()) && contains(newEdge->getDstNode()))) {
+        bool srcIsValid = contains(newEdge->getSrcNode());
+        m_arena.destroy(newEdge);
+        throw InvalidNodeException(srcIsValid ? "destination node is not in the graph"
+                                              : "source node is not in the graph");
+    }
+
+    m_edges.push_back(newEdge);
+    return *newEdge;
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/** Edges of any type: the virtual call. */
+template<>
+inline double Graph::getWeight<Edge>(Edge* pEdge)
+{
+    return pEdge->getWeight();
 }
 
 
 /* --------------------------------------------------------------------------------------------- */
 
 template<class T>
-T& Graph::makeEdge(T&& edge)
+Graph::tDijkstraMap Graph::findDistancesDijkstraV1(const Node& rSrcNode, const Node* pDstNode, Node** pFoundDst)
 {
-    // check if src and destination nodes are in the graph
-    if (std::find(m_nodes.begin(), m_nodes.end(), &edge.getDstNode()) == m_nodes.end()) {
+    if (!hasOnlyEdgesOf<T>()) {
+        throw Exception("the graph has edges of another type");
+    }
+    return runDijkstraV1<T>(rSrcNode, pDstNode, pFoundDst);
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class T>
+Graph::tDijkstraMap Graph::runDijkstraV1(const Node& rSrcNode, const Node* pDstNode, Node** pFoundDst)
+{
+    tDijkstraMap nodeTable;  // 存储最短路径信息
+    std::priority_queue<tHeapEntry, std::vector<tHeapEntry>, CompareDist> minHeap;
+    std::unordered_set<Node*> visited;  // 跳过已确定最短路径的节点
+    // 检查源节点（常数时间）
+    if (!contains(rSrcNode)) {
         throw InvalidNodeException("source node is not in the graph");
     }
+    Node* pSrc = const_cast<Node*>(&rSrcNode);
 
-    if (std::find(m_nodes.begin(), m_nodes.end(), &edge.getSrcNode()) == m_nodes.end()) {
-        throw InvalidNodeException("destination node is not in the graph");
+    // 检查目标节点（可选）
+    Node* pDst = nullptr;
+    if (pDstNode != nullptr) {
+        if (!contains(*pDstNode)) {
+            throw InvalidNodeException("destination node is not in the graph");
+        }
+        pDst = const_cast<Node*>(pDstNode);
     }
 
-    T* newEdge = new T(std::move(edge));
-    m_edges.push_back(newEdge);
-    return *newEdge;
+    // 初始化所有节点为“未知距离”
+    for (Node* pNode : m_nodes) {
+        nodeTable[pNode] = { std::numeric_limits<double>::max(), nullptr, nullptr };
+    }
+
+    // 初始化源节点
+    nodeTable[pSrc].distance = 0.0;
+    minHeap.push({ pSrc, 0.0 });
+
+    // 主循环
+    while (!minHeap.empty()) {
+        Node* u = minHeap.top().first;
+        minHeap.pop();
+
+        if (visited.count(u)) {
+            continue;  // 已处理过
+        }
+        visited.insert(u);
+
+        // 如果到达目标节点，提前返回
+        if (u == pDst) {
+            *pFoundDst = u;
+            return nodeTable;
+        }
+
+        // 遍历所有出边
+        for (Edge* pOutEdge : u->getOutEdges()) {
+            Node* v = &pOutEdge->getDstNode();
+            double newDistance = nodeTable[u].distance + getWeight<T>(pOutEdge);
+            tDijkstraInfo& vInfo = nodeTable[v];
+
+            if (newDistance < vInfo.distance) {
+                vInfo.distance = newDistance;
+                vInfo.prevNode = u;
+                vInfo.prevEdge = pOutEdge;
+                minHeap.push({v, newDistance});
+            }
+        }
+    }
+
+    // 未找到目标节点
+    *pFoundDst = nullptr;
+    return nodeTable;
 }
 
 
@@ -0,0 +1,163 @@
+#ifndef HUBLABELS_H
+#define HUBLABELS_H
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "CsrGraph.h"
+
+class ContractionHierarchy;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A hub labeling for distance queries without a graph search.
+*
+* Every node v has a forward label of hubs h with the distance from v to h and a backward label
+* of hubs with the distance from h to v. The labels cover all shortest paths: the distance from
+* src to dst is the minimum of forward(src, h) + backward(dst, h) over the hubs h that both labels
+* share, so a query is a merge of two sorted arrays.
+*
+* The labels are computed from a ContractionHierarchy in the order of decreasing rank: the label
+* of v is v itself plus the labels of its upward (downward) neighbours, and an entry is pruned,
+* if the labels computed so far prove a shorter distance to its hub.
+*
+* The hubs and distances of all labels are stored in two contiguous arrays, sorted by hub within
+* each label. Every entry also remembers the arc of the hierarchy that it was derived over, so
+* the path of a query can be unpacked, as long as the hierarchy is still available.
+*/
+class HubLabels
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+
+public:
+
+    //! @Lifetime
+
+    /** Creates empty labels, see loadFromFile(). */
+    HubLabels();
+
+    /** Computes the labels from rHierarchy, which is needed by findShortestPath afterwards. */
+    explicit HubLabels(const ContractionHierarchy& rHierarchy);
+
+
+    //! @Label Information
+
+    tIndex getNumNodes() const { return m_numNodes; }
+
+    /** @return the number of entries of all forward and backward labels. */
+    size_t getNumEntries() const { return m_hubs.size(); }
+
+    /** @return the size of the forward (or backward) label of node. */
+    tIndex getLabelSize(tIndex node, bool forward) const {
+        return m_first[labelIndex(node, forward) + 1] - m_first[labelIndex(node, forward)];
+    }
+
+
+    //! @Queries
+
+    /** @return the distance from src to dst (node indices) or std::numeric_limits<double>::max(). */
+    double getDistance(tIndex src, tIndex dst) const {
+        tIndex hub;
+        return findHub(src, dst, hub);
+    }
+
+    /**
+    * @return the distance from rSrc to rDst or std::numeric_limits<double>::max().
+    * @throw Graph::InvalidNodeException if a node is not in the snapshot of the labels.
+    */
+    double getDistance(const Node& rSrc, const Node& rDst) const;
+
+    /**
+    * Writes the original edges of a shortest path from src to dst into rPath.
+    * @return true, if dst is reachable from src.
+    * @throw Graph::Exception if the labels were loaded without their hierarchy.
+    */
+    bool findShortestPath(tIndex src, tIndex dst, Graph::tEdges& rPath) const;
+
+    /** @return a shortest path from rSrc to rDst, empty if there is none. */
+    Graph::tPath findShortestPath(const Node& rSrc, const Node& rDst) const;
+
+
+    //! @Serialization
+
+    /**
+    * Writes the labels into a binary file.
+    * @throw Graph::Exception if the file cannot be written.
+    */
+    void saveToFile(const std::string& rFilename) const;
+
+    /**
+    * Replaces the labels by the ones in the file, for distance queries on a snapshot of the same graph.
+    * @throw Graph::Exception if the file cannot be read or was made for a different graph.
+    */
+    void loadFromFile(const CsrGraph& rGraph, const std::string& rFilename);
+
+    /**
+    * Like loadFromFile above, for labels that were computed from rHierarchy, so that paths can be
+    * unpacked. The hierarchy has to be computed with the same options as the one of the file.
+    */
+    void loadFromFile(const ContractionHierarchy& rHierarchy, const std::string& rFilename);
+
+
+private:
+
+    static size_t labelIndex(tIndex node, bool forward) { return static_cast<size_t>(node) * 2 + (forward ? 0 : 1); }
+
+    /**
+    * Merges the forward label of src with the backward label of dst.
+    * @return the distance, rHub receives the hub of a shortest path or INVALID_INDEX.
+    */
+    double findHub(tIndex src, tIndex dst, tIndex& rHub) const {
+        const tIndex* pHubs = m_hubs.data();
+        const double* pDistances = m_distances.data();
+        size_t i = m_first[labelIndex(src, true)], endI = m_first[labelIndex(src, true) + 1];
+        size_t j = m_first[labelIndex(dst, false)], endJ = m_first[labelIndex(dst, false) + 1];
+
+        // the branches only depend on the comparison of the hubs, which keeps the loop tight
+        double best = std::numeric_limits<double>::max();
+        rHub = CsrGraph::INVALID_INDEX;
+        while (i < endI && j < endJ) {
+            tIndex hubI = pHubs[i], hubJ = pHubs[j];
+            if (hubI == hubJ) {
+                double distance = pDistances[i] + pDistances[j];
+                if (distance < best) {
+                    best = distance;
+                    rHub = hubI;
+                }
+            }
+            i += (hubI <= hubJ) ? 1 : 0;
+            j += (hubJ <= hubI) ? 1 : 0;
+        }
+        return best;
+    }
+
+    /** @return the position of hub in the label or the end of the label, if it is not there. */
+    size_t findEntry(tIndex node, bool forward, tIndex hub) const;
+
+    /** Checks the header of a label file and reads the labels. */
+    void load(const CsrGraph& rGraph, tIndex numArcs, const std::string& rFilename);
+
+    const ContractionHierarchy* m_pHierarchy;
+    const CsrGraph* m_pGraph;
+    tIndex m_numNodes;
+    tIndex m_numEdges;
+
+    // the label of node v in direction d is [m_first[2v + d], m_first[2v + d + 1]) with d = 0
+    // for forward labels and d = 1 for backward labels
+    std::vector<size_t> m_first;
+    std::vector<tIndex> m_hubs;
+    std::vector<double> m_distances;
+    std::vector<tIndex> m_arcs;     // the arcs of the hierarchy, INVALID_INDEX for the node itself
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
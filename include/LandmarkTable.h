@@ -0,0 +1,194 @@
+#ifndef LANDMARKTABLE_H
+#define LANDMARKTABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The landmark distances of ALT (A*, landmarks and triangle inequality).
+*
+* For a few landmark nodes L, the table holds the distances from L to every node and from every
+* node to L. By the triangle inequality, d(L, t) - d(L, v) and d(v, L) - d(t, L) are lower bounds
+* of d(v, t), which LandmarkHeuristic feeds into the AStarEngine.
+*
+* The distances are 32 bit fixed point numbers in multiples of tOptions::unit. They are computed
+* with every edge weight rounded down to a multiple of the unit, which keeps the bounds admissible
+* and consistent, so A* still finds shortest paths. The bounds stay valid when weights grow (e.g.
+* traffic updates that slow edges down), and the table only refers to node indices, so it can be
+* used with a later snapshot of the same graph. After a weight decreased, it has to be rebuilt.
+*/
+class LandmarkTable
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** How the landmarks are chosen. */
+    enum tStrategy
+    {
+        // every landmark is the node that is farthest from the landmarks chosen so far
+        STRATEGY_FARTHEST,
+        // every landmark is a leaf of a shortest path tree in the region where the current
+        // landmarks give the worst bounds (Goldberg and Werneck)
+        STRATEGY_AVOID
+    };
+
+    struct tOptions
+    {
+        tOptions() : numLandmarks(16), strategy(STRATEGY_AVOID), unit(1e-3) { }
+
+        unsigned numLandmarks;
+        tStrategy strategy;
+
+        // the resolution of the stored distances in weight units, e.g. 1e-3 for meters with km weights
+        double unit;
+    };
+
+    /** A stored distance that marks an unreachable node. */
+    static const uint32_t INFINITE_DISTANCE = 0xFFFFFFFFu;
+
+
+public:
+
+    //! @Lifetime
+
+    /** Creates an empty table, see loadFromFile(). */
+    LandmarkTable();
+
+    /**
+    * Chooses the landmarks and computes their distances on rGraph.
+    * @throw Graph::Exception if a distance does not fit into 32 bits, choose a larger unit then.
+    */
+    explicit LandmarkTable(const CsrGraph& rGraph, const tOptions& rOptions = tOptions());
+
+
+    //! @Table Information
+
+    unsigned getNumLandmarks() const { return static_cast<unsigned>(m_landmarks.size()); }
+    tIndex getNumNodes() const { return m_numNodes; }
+    double getUnit() const { return m_unit; }
+
+    /** @return the node index of the i-th landmark. */
+    tIndex getLandmark(unsigned i) const { return m_landmarks[i]; }
+
+    /** @return the distance from landmark i to node in units or INFINITE_DISTANCE. */
+    uint32_t getForward(tIndex node, unsigned i) const {
+        return m_distances[static_cast<size_t>(node) * 2 * getNumLandmarks() + i];
+    }
+
+    /** @return the distance from node to landmark i in units or INFINITE_DISTANCE. */
+    uint32_t getBackward(tIndex node, unsigned i) const {
+        return m_distances[(static_cast<size_t>(node) * 2 + 1) * getNumLandmarks() + i];
+    }
+
+    /** @return the best lower bound of the distance from src to dst over all landmarks. */
+    double getLowerBound(tIndex src, tIndex dst) const;
+
+    /** @return the lower bound from src to dst of landmark i in units, may be negative. */
+    int64_t getLandmarkBound(tIndex src, tIndex dst, unsigned i) const;
+
+
+    //! @Serialization
+
+    /**
+    * Writes the table into a binary file.
+    * @throw Graph::Exception if the file cannot be written.
+    */
+    void saveToFile(const std::string& rFilename) const;
+
+    /**
+    * Replaces the table by the one in the file, which must have been computed on a snapshot of
+    * the same graph.
+    * @throw Graph::Exception if the file cannot be read or was made for a different graph.
+    */
+    void loadFromFile(const CsrGraph& rGraph, const std::string& rFilename);
+
+
+private:
+
+    // the distances of the landmarks chosen so far, one column per landmark
+    typedef std::vector<std::vector<uint32_t> > tColumns;
+
+    /** Writes the (rounded) distances from or to the landmark into rColumn. */
+    void computeColumn(const CsrGraph& rGraph, tIndex landmark, bool forward, RoutingContext& rContext,
+                       std::vector<uint32_t>& rColumn) const;
+
+    /**
+    * A Dijkstra with the weights rounded down to units on the forward or backward edges.
+    * @param pOrder receives the nodes in the order they were settled, if not NULL.
+    */
+    void runRounded(const CsrGraph& rGraph, tIndex root, bool forward, RoutingContext& rContext,
+                    std::vector<tIndex>* pOrder) const;
+
+    /** @return the node that is farthest from the landmarks so far. */
+    tIndex chooseFarthest(const tColumns& rForward) const;
+
+    /** @return a leaf of the shortest path tree of root in the region with the worst bounds. */
+    tIndex chooseAvoid(const CsrGraph& rGraph, tIndex root, const tColumns& rForward, const tColumns& rBackward,
+                       RoutingContext& rContext) const;
+
+    std::vector<tIndex> m_landmarks;
+
+    // node major: the forward distances of all landmarks, then their backward distances
+    std::vector<uint32_t> m_distances;
+
+    tIndex m_numNodes;
+    tIndex m_numEdges;
+    double m_unit;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The A* heuristic policy of ALT. Per query, it uses the landmarks with the best bounds between
+* source and target, which keeps estimate() cheap for tables with many landmarks.
+*/
+class LandmarkHeuristic
+{
+
+public:
+
+    static const unsigned MAX_ACTIVE = 16;
+
+    /** @param numActive the number of landmarks to use, at most MAX_ACTIVE. */
+    LandmarkHeuristic(const LandmarkTable& rTable, CsrGraph::tIndex src, CsrGraph::tIndex dst, unsigned numActive = 4);
+
+    double estimate(CsrGraph::tIndex node) const {
+        int64_t best = 0;
+        for (unsigned k = 0; k < m_numActive; k++) {
+            unsigned i = m_active[k];
+            uint32_t forward = m_rTable.getForward(node, i);
+            uint32_t backward = m_rTable.getBackward(node, i);
+            if (forward != LandmarkTable::INFINITE_DISTANCE && m_targetForward[k] != LandmarkTable::INFINITE_DISTANCE) {
+                best = std::max(best, static_cast<int64_t>(m_targetForward[k]) - forward);
+            }
+            if (backward != LandmarkTable::INFINITE_DISTANCE && m_targetBackward[k] != LandmarkTable::INFINITE_DISTANCE) {
+                best = std::max(best, static_cast<int64_t>(backward) - m_targetBackward[k]);
+            }
+        }
+        return best * m_unit;
+    }
+
+private:
+
+    const LandmarkTable& m_rTable;
+    double m_unit;
+    unsigned m_numActive;
+    unsigned m_active[MAX_ACTIVE];
+    uint32_t m_targetForward[MAX_ACTIVE];
+    uint32_t m_targetBackward[MAX_ACTIVE];
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,342 @@
+#ifndef MULTILEVELOVERLAY_H
+#define MULTILEVELOVERLAY_H
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+class ThreadPool;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Customizable Route Planning (CRP): a multilevel overlay over a CsrGraph for weights that change
+* often, e.g. from traffic feeds.
+*
+* The metric independent part only depends on the topology. The nodes are partitioned by
+* recursive bisection of their coordinates into nested cells of at most tOptions::cellSizes
+* nodes per level. A node is an entry of its cell on a level, if it has an in-edge from another
+* cell of that level, and an exit, if it has an out-edge into another cell.
+*
+* customize() reads the current Edge::getWeight() of every edge and computes the distances
+* within every cell from each of its entries to each of its exits (the clique of the cell). The
+* cliques of a level are computed from the ones of the level below, with one search per entry,
+* and the searches of a level run in parallel.
+*
+* A query is a bidirectional Dijkstra that uses the original edges only in the lowest cells of
+* the source and the target. Everywhere else it uses the cliques of the highest level whose cell
+* contains neither of them, plus the edges between the cells of that level.
+*/
+class MultilevelOverlay
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** Parameters of the partition and the customization. */
+    struct tOptions
+    {
+        tOptions() : numThreads(0) {
+            tIndex sizes[] = { 256, 2048, 16384, 131072 };
+            cellSizes.assign(sizes, sizes + 4);
+        }
+
+        // the maximal number of nodes of a cell on each level, from the lowest to the highest
+        // level. Levels with a cell size of at least the number of nodes are left out.
+        std::vector<tIndex> cellSizes;
+
+        // the threads of the customization (0: one per hardware thread)
+        unsigned numThreads;
+    };
+
+    /** The buffers of a search within a cell, needed to unpack clique arcs. */
+    struct tWorkspace
+    {
+        SearchSpace space;
+        RoutingContext::tHeap heap;
+        std::vector<tIndex> arcs;
+    };
+
+    /** The distance of a clique arc between nodes that are not connected within their cell. */
+    static double infinity() { return std::numeric_limits<double>::max(); }
+
+
+public:
+
+    //! @Lifetime
+
+    /** Partitions rGraph and runs the first customization. The snapshot must outlive the overlay. */
+    explicit MultilevelOverlay(const CsrGraph& rGraph, const tOptions& rOptions = tOptions());
+
+    ~MultilevelOverlay();
+
+    /**
+    * Reads the current weights from the Edge objects of the snapshot and recomputes the cliques
+    * of all cells. The edges must not be deleted, and no query may run at the same time.
+    */
+    void customize();
+
+
+    //! @Overlay Information
+
+    const CsrGraph& getGraph() const { return m_rGraph; }
+
+    /** @return the number of overlay levels, the original graph is level 0. */
+    unsigned getNumLevels() const { return m_numLevels; }
+
+    /** @return the number of cells of a level in [1, getNumLevels()]. */
+    tIndex getNumCells(unsigned level) const { return m_firstCell[level] - m_firstCell[level - 1]; }
+
+    /** @return the id of the cell that contains node on a level, the ids are unique over all levels. */
+    tIndex getCell(tIndex node, unsigned level) const { return getNodeLevel(node, level).cell; }
+
+    /** @return the number of nodes of the largest cell, the size of the search space of tWorkspace. */
+    tIndex getMaxCellSize() const { return m_maxCellSize; }
+
+    /** @return the number of clique arcs of all levels. */
+    size_t getNumCliqueArcs() const { return m_cliques.size(); }
+
+    /** @return the weight of an edge in the last customization. */
+    double getWeight(tIndex edge) const { return m_weights[edge]; }
+
+    /**
+    * Arcs are edge indices of the CsrGraph or, from getGraph().getNumEdges() on, clique arcs.
+    * @return the first node of the arc.
+    */
+    tIndex getTail(tIndex arc) const;
+
+    /** @return the last node of the arc. */
+    tIndex getHead(tIndex arc) const;
+
+    /** @return the level of the cells the query uses for node, 0 if it uses the original edges. */
+    unsigned getQueryLevel(tIndex node, tIndex src, tIndex dst) const;
+
+    /** Calls relax(head, weight, arc) for the arcs that leave node on a level. */
+    template <class tRelax>
+    void forEachOutArc(tIndex node, unsigned level, tRelax relax) const;
+
+    /** Calls relax(tail, weight, arc) for the arcs that lead into node on a level. */
+    template <class tRelax>
+    void forEachInArc(tIndex node, unsigned level, tRelax relax) const;
+
+    /** Appends the original edges of an arc (recursively unpacked, if it is a clique arc) to rPath. */
+    void unpackArc(tIndex arc, tWorkspace& rWork, Graph::tEdges& rPath) const;
+
+
+    //! @Routing
+
+    /**
+    * Finds a shortest path with a CRP query. The result has the same length as the one of
+    * Graph::findShortestPathDijkstra with the weights of the last customization.
+    * @throw Graph::InvalidNodeException if a node is not in the snapshot.
+    */
+    Graph::tPath findShortestPath(const Node& rSrc, const Node& rDst) const;
+
+    /** CRP query on a reusable context, see CsrGraph::findShortestPathDijkstra for the parameters. */
+    bool findShortestPath(const Node& rSrc, const Node& rDst, RoutingContext& rContext, Graph::tEdges& rPath) const;
+
+
+private:
+
+    /** A cell: a range of m_order, its entries and exits and its clique (entries x exits, row major). */
+    struct tCell
+    {
+        tIndex begin;
+        tIndex end;
+        tIndex firstEntry;
+        tIndex numEntries;
+        tIndex firstExit;
+        tIndex numExits;
+        size_t firstClique;
+    };
+
+    /** The cell of a node on a level and its index among the entries and exits of the cell. */
+    struct tNodeLevel
+    {
+        tIndex cell;
+        tIndex entry;
+        tIndex exit;
+    };
+
+    const tNodeLevel& getNodeLevel(tIndex node, unsigned level) const {
+        return m_nodeLevels[static_cast<size_t>(node) * m_numLevels + level - 1];
+    }
+
+    /** Orders the nodes by recursive bisection and creates the cells of all levels. */
+    void partition(const std::vector<tIndex>& rCellSizes);
+
+    /** Finds the entries and exits of all cells. */
+    void findBoundaries();
+
+    /** Computes the clique row of one entry from the level below. */
+    void computeCliqueRow(unsigned level, tIndex entry, tWorkspace& rWork);
+
+    /**
+    * A Dijkstra from src within the cell of src on a level, over the arcs of the level below. It
+    * stops when dst is settled or, if dst is INVALID_INDEX, when all exits of the cell are settled.
+    * The search space is indexed by the position of the nodes in the cell.
+    */
+    void searchCell(unsigned level, tIndex src, tIndex dst, tWorkspace& rWork) const;
+
+    /** @return the cell and the indices of its entry and exit of a clique arc. */
+    const tCell& findCliqueArc(tIndex arc, tIndex& rEntry, tIndex& rExit) const;
+
+    const CsrGraph& m_rGraph;
+    std::unique_ptr<ThreadPool> m_pPool;
+
+    unsigned m_numLevels;
+    std::vector<tIndex> m_order;            // the nodes, every cell is a contiguous range
+    std::vector<tIndex> m_position;         // the position of every node in m_order
+    std::vector<tNodeLevel> m_nodeLevels;   // node major, m_numLevels entries per node
+
+    std::vector<tCell> m_cells;             // ordered by level
+    std::vector<tIndex> m_firstCell;        // m_numLevels + 1 entries
+    std::vector<tIndex> m_entries;          // the nodes, ordered by level and cell
+    std::vector<tIndex> m_firstEntry;       // m_numLevels + 1 entries
+    std::vector<tIndex> m_exits;
+    tIndex m_maxCellSize;
+
+    // the metric
+    std::vector<double> m_weights;
+    std::vector<double> m_cliques;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template <class tRelax>
+void MultilevelOverlay::forEachOutArc(tIndex node, unsigned level, tRelax relax) const
+{
+    tIndex end = m_rGraph.firstOut(node + 1);
+    if (level == 0) {
+        for (tIndex e = m_rGraph.firstOut(node); e < end; e++) {
+            relax(m_rGraph.getHead(e), m_weights[e], e);
+        }
+        return;
+    }
+
+    const tNodeLevel& rLevel = getNodeLevel(node, level);
+    if (rLevel.entry != CsrGraph::INVALID_INDEX) {
+        const tCell& rCell = m_cells[rLevel.cell];
+        size_t row = rCell.firstClique + static_cast<size_t>(rLevel.entry) * rCell.numExits;
+        for (tIndex j = 0; j < rCell.numExits; j++) {
+            if (m_cliques[row + j] != infinity()) {
+                relax(m_exits[rCell.firstExit + j], m_cliques[row + j],
+                      m_rGraph.getNumEdges() + static_cast<tIndex>(row + j));
+            }
+        }
+    }
+
+    // the edges within the cell are covered by the clique
+    for (tIndex e = m_rGraph.firstOut(node); e < end; e++) {
+        if (getNodeLevel(m_rGraph.getHead(e), level).cell != rLevel.cell) {
+            relax(m_rGraph.getHead(e), m_weights[e], e);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+template <class tRelax>
+void MultilevelOverlay::forEachInArc(tIndex node, unsigned level, tRelax relax) const
+{
+    tIndex end = m_rGraph.firstIn(node + 1);
+    if (level == 0) {
+        for (tIndex i = m_rGraph.firstIn(node); i < end; i++) {
+            tIndex e = m_rGraph.getInEdge(i);
+            relax(m_rGraph.getTail(e), m_weights[e], e);
+        }
+        return;
+    }
+
+    const tNodeLevel& rLevel = getNodeLevel(node, level);
+    if (rLevel.exit != CsrGraph::INVALID_INDEX) {
+        const tCell& rCell = m_cells[rLevel.cell];
+        size_t column = rCell.firstClique + rLevel.exit;
+        for (tIndex i = 0; i < rCell.numEntries; i++) {
+            size_t index = column + static_cast<size_t>(i) * rCell.numExits;
+            if (m_cliques[index] != infinity()) {
+                relax(m_entries[rCell.firstEntry + i], m_cliques[index],
+                      m_rGraph.getNumEdges() + static_cast<tIndex>(index));
+            }
+        }
+    }
+
+    for (tIndex i = m_rGraph.firstIn(node); i < end; i++) {
+        tIndex e = m_rGraph.getInEdge(i);
+        if (getNodeLevel(m_rGraph.getTail(e), level).cell != rLevel.cell) {
+            relax(m_rGraph.getTail(e), m_weights[e], e);
+        }
+    }
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The query of a MultilevelOverlay: a bidirectional Dijkstra in which every node uses the arcs of
+* its query level (see MultilevelOverlay::getQueryLevel). It stops when the sum of both heap
+* minima is not better than the best path found so far.
+*
+* The engine keeps its state in the forward and backward space of a RoutingContext and a
+* workspace of its own for unpacking the clique arcs.
+*/
+class CRPQueryEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** Creates an engine with its own context. */
+    explicit CRPQueryEngine(const MultilevelOverlay& rOverlay);
+
+    /** Creates an engine that works on rContext. The context must outlive the engine. */
+    CRPQueryEngine(const MultilevelOverlay& rOverlay, RoutingContext& rContext);
+
+    /**
+    * Searches a shortest path from src to dst (node indices of the CsrGraph).
+    * @return true, if dst is reachable from src.
+    */
+    bool run(tIndex src, tIndex dst);
+
+    /** @return the length of the path found by the last run or std::numeric_limits<double>::max(). */
+    double getDistance() const { return m_distance; }
+
+    /** @return the path of original edges found by the last run, empty if there is none. */
+    Graph::tPath getPath();
+
+    /** Writes the unpacked path of the last run into rPath, which does not allocate if it has the capacity. */
+    void getPath(Graph::tEdges& rPath);
+
+    /** @return the number of nodes settled by both searches of the last run. */
+    size_t getNumSettled() const { return m_numSettled; }
+
+
+private:
+
+    /** Settles the next node of one direction and relaxes the arcs of its query level. */
+    void step(bool forward);
+
+    const MultilevelOverlay& m_rOverlay;
+    std::unique_ptr<RoutingContext> m_pOwnContext;
+    RoutingContext& m_rContext;
+    MultilevelOverlay::tWorkspace m_workspace;
+    std::vector<tIndex> m_arcs;
+
+    tIndex m_src;
+    tIndex m_dst;
+    double m_distance;
+    tIndex m_meetingNode;
+    size_t m_numSettled;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -2,9 +2,11 @@
 #define NODE_H
 
 #include <string>
-#include <list>
+
+#include "SmallVector.h"
 
 class Edge;
+class Graph;
 
 
 //-------------------------------------------------------------------------------------------------
@@ -20,16 +22,29 @@ public:
 
     enum Direction { DIR_IN, DIR_OUT, DIR_BOTH };
 
+    /**
+    * The adjacency of a node is stored contiguously, inline for up to 4 edges per direction.
+    * The order of the edges changes, when an edge is removed (swap and pop).
+    */
+    typedef SmallVector<Edge*, 4> tEdgeVector;
+
+    class NeighbourIterator;
+    class NeighbourRange;
+
     virtual ~Node() {}
 
     const std::string& getId() const { return m_id; }
     double getLon() const { return m_lon; }
     double getLat() const { return m_lat; }
 
-    std::list<Edge*>& getOutEdges() { return m_outEdges; }
-    std::list<Edge*>& getInEdges() { return m_inEdges; }
+    const tEdgeVector& getOutEdges() const { return m_outEdges; }
+    const tEdgeVector& getInEdges() const { return m_inEdges; }
 
-    std::list<Node*> getNeighbours(Direction direction = DIR_BOTH);
+    /**
+    * Iterates over the destination nodes of the out-edges and / or the source nodes of the
+    * in-edges. The range is a view on the adjacency of this node and does not allocate.
+    */
+    NeighbourRange getNeighbours(Direction direction = DIR_BOTH) const;
 
     virtual bool operator==(const Node& rOther) const { return m_id == rOther.m_id; }
     virtual bool operator<(const Node& rOther) const { return m_id < rOther.m_id; }
@@ -40,17 +55,85 @@ private:
     double m_lon = 0.0;
     double m_lat = 0.0;
 
-    std::list<Edge*> m_outEdges;
-    std::list<Edge*> m_inEdges;
+    // maintained by the Edge class
+    tEdgeVector m_outEdges;
+    tEdgeVector m_inEdges;
 
     static int s_numInstances;
 
+    // The graph that owns this node, so that the graph can check its membership in constant time.
+    // The stamp is not copied together with the node, a copy is not owned by any graph.
+    struct tOwnerStamp
+    {
+        tOwnerStamp() : pGraph(NULL) { }
+        tOwnerStamp(const tOwnerStamp&) : pGraph(NULL) { }
+        tOwnerStamp& operator=(const tOwnerStamp&) { return *this; }
+
+        const Graph* pGraph;
+    };
+
+    tOwnerStamp m_owner;
+
+    friend class Graph;
+    friend class Edge;
+
 #ifdef TESTING
     friend class GraphTesting;
 #endif
 };
 
 
+//-------------------------------------------------------------------------------------------------
+
+/** Forward iterator over the neighbour nodes, first over the out-edges then over the in-edges. */
+class Node::NeighbourIterator
+{
+
+public:
+
+    NeighbourIterator(Edge* const* pOut, Edge* const* pOutEnd, Edge* const* pIn)
+        : m_pOut(pOut), m_pOutEnd(pOutEnd), m_pIn(pIn) { }
+
+    Node* operator*() const;
+
+    NeighbourIterator& operator++() {
+        if (m_pOut != m_pOutEnd) m_pOut++; else m_pIn++;
+        return *this;
+    }
+
+    bool operator==(const NeighbourIterator& rOther) const {
+        return m_pOut == rOther.m_pOut && m_pIn == rOther.m_pIn;
+    }
+    bool operator!=(const NeighbourIterator& rOther) const { return !(*this == rOther); }
+
+private:
+
+    Edge* const* m_pOut;
+    Edge* const* m_pOutEnd;
+    Edge* const* m_pIn;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+
+class Node::NeighbourRange
+{
+
+public:
+
+    NeighbourRange(const NeighbourIterator& rBegin, const NeighbourIterator& rEnd)
+        : m_begin(rBegin), m_end(rEnd) { }
+
+    NeighbourIterator begin() const { return m_begin; }
+    NeighbourIterator end() const { return m_end; }
+
+private:
+
+    NeighbourIterator m_begin;
+    NeighbourIterator m_end;
+};
+
+
 //-------------------------------------------------------------------------------------------------
 
 #endif
\ No newline at end of file
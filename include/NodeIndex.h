@@ -0,0 +1,74 @@
+#ifndef NODEINDEX_H
+#define NODEINDEX_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Node.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A hash index from node ids to nodes (open addressing with linear probing).
+*
+* The index does not store its own copies of the ids, it compares against Node::getId().
+* Because of this, lookups can be done with any character range (std::string, const char* or
+* pointer and length) without allocating a temporary std::string.
+*/
+class NodeIndex
+{
+
+public:
+
+    NodeIndex() : m_size(0) { }
+
+    /** @return the node with the given id or NULL if not found. */
+    Node* find(const char* id, size_t length) const;
+    Node* find(const char* id) const { return find(id, std::strlen(id)); }
+    Node* find(const std::string& id) const { return find(id.data(), id.size()); }
+
+    /**
+    * Adds the node to the index.
+    * @return false, if there is already a node with the same id. The index is not changed then.
+    */
+    bool insert(Node* pNode);
+
+    /**
+    * Removes exactly the given node object from the index.
+    * @return true if the node was found and removed, false otherwise.
+    */
+    bool erase(const Node* pNode);
+
+    /** Prepares the index for numNodes nodes, so that no rehashing is needed until then. */
+    void reserve(size_t numNodes);
+
+    void clear();
+
+    size_t size() const { return m_size; }
+
+
+private:
+
+    struct tSlot
+    {
+        size_t hash;
+        Node* pNode;    // NULL for empty slots
+    };
+
+    static size_t hash(const char* id, size_t length);
+
+    /** @return the slot of the node with the given id or the empty slot that ends the probing. */
+    size_t findSlot(const char* id, size_t length, size_t hash) const;
+
+    void rehash(size_t numSlots);
+
+    std::vector<tSlot> m_slots;     // the size is always a power of two
+    size_t m_size;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef OBJECTARENA_H
+#define OBJECTARENA_H
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A slab allocator for objects of a single size.
+* Objects are bump-allocated from large contiguous chunks, released slots are reused through a
+* free list. The chunks are only given back to the system when the pool is destroyed.
+*/
+class SlabPool
+{
+
+public:
+
+    SlabPool(size_t objectSize, size_t alignment);
+    ~SlabPool();
+
+    /** @return uninitialized memory for one object. */
+    void* allocate();
+
+    /** Gives the memory of an already destructed object back to the pool. */
+    void release(void* p);
+
+    /** @return the number of allocated and not yet released objects. */
+    size_t getNumObjects() const { return m_numObjects; }
+
+
+private:
+
+    SlabPool(const SlabPool&);
+    SlabPool& operator=(const SlabPool&);
+
+    size_t m_slotSize;
+    size_t m_slotsPerChunk;
+    std::vector<char*> m_chunks;
+    char* m_pNext;          // next unused slot of the current chunk
+    char* m_pEnd;           // end of the current chunk
+    void* m_pFreeList;      // released slots, linked through their first bytes
+    size_t m_numObjects;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Allocates polymorphic objects in one SlabPool per concrete type.
+* Objects of the same type lie next to each other in memory, and all memory is freed in bulk
+* when the arena is destroyed. Objects must be destroyed with destroy() before that, so that
+* their destructors are run.
+*/
+class ObjectArena
+{
+
+public:
+
+    ObjectArena() : m_pLastType(NULL), m_pLastPool(NULL) { }
+
+    /** Constructs a T in the pool for type T. */
+    template<class T, class... Args>
+    T* create(Args&&... args);
+
+    /**
+    * Runs the (virtual) destructor of the object and releases its memory to the pool of its
+    * dynamic type. The object must have been created by this arena.
+    */
+    template<class T>
+    void destroy(T* p);
+
+    /** @return the number of live objects of exactly the type T. */
+    template<class T>
+    size_t count() const;
+
+
+private:
+
+    SlabPool& getPool(const std::type_info& type, size_t size, size_t alignment);
+
+    std::unordered_map<std::type_index, std::unique_ptr<SlabPool> > m_pools;
+
+    // cache for the last used pool, since objects are mostly created in runs of the same type
+    const std::type_info* m_pLastType;
+    SlabPool* m_pLastPool;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class T, class... Args>
+T* ObjectArena::create(Args&&... args)
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+    SlabPool& rPool = getPool(typeid(T), sizeof(T), alignof(T));
+    void* pMemory = rPool.allocate();
+    try {
+        return new (pMemory) T(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        rPool.release(pMemory);
+        throw;
+    }
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class T>
+void ObjectArena::destroy(T* p)
+{
+    // the pool belongs to the dynamic type, and the memory starts at the most derived object
+    SlabPool& rPool = getPool(typeid(*p), 0, 0);
+    void* pMemory = dynamic_cast<void*>(p);
+    p->~T();
+    rPool.release(pMemory);
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+template<class T>
+size_t ObjectArena::count() const
+{
+    auto it = m_pools.find(std::type_index(typeid(T)));
+    return it != m_pools.end() ? it->second->getNumObjects() : 0;
+}
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
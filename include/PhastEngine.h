@@ -0,0 +1,84 @@
+#ifndef PHASTENGINE_H
+#define PHASTENGINE_H
+
+#include <vector>
+
+#include "ContractionHierarchy.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* One to all distances with PHAST on a ContractionHierarchy.
+*
+* A tree is computed in two phases: an upward search from the source in the hierarchy, and a
+* sweep over all nodes in the order of decreasing rank, which takes the minimum over the arcs
+* from higher ranked nodes into every node. The sweep does not need a priority queue, and the
+* engine stores the nodes, arcs and distances in the order of the sweep, so it reads the arrays
+* nearly sequentially.
+*
+* Up to MAX_SOURCES trees are computed in one sweep. Their distances are interleaved per node,
+* so the inner loop of the sweep is a short loop over the sources that the compiler can vectorize.
+*/
+class PhastEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    static const unsigned MAX_SOURCES = 16;
+
+
+public:
+
+    /** Prepares the sweep order of rHierarchy, which must outlive the engine. */
+    explicit PhastEngine(const ContractionHierarchy& rHierarchy);
+
+    /** Computes the distances from src to all nodes. */
+    void run(tIndex src);
+
+    /**
+    * Computes the distances from every source to all nodes in one sweep.
+    * @throw Graph::Exception if there are more than MAX_SOURCES sources.
+    */
+    void run(const std::vector<tIndex>& rSources);
+
+    /** @return the number of sources of the last run. */
+    unsigned getNumSources() const { return m_numSources; }
+
+    /** @return the distance from the i-th source of the last run to node or std::numeric_limits<double>::max(). */
+    double getDistance(tIndex node, unsigned source = 0) const {
+        return m_distances[static_cast<size_t>(m_position[node]) * m_numSources + source];
+    }
+
+    /** Writes the distances from the i-th source of the last run to all nodes into rDistances, indexed by node. */
+    void getDistances(unsigned source, std::vector<double>& rDistances) const;
+
+
+private:
+
+    /** An arc into a node of the sweep, from the node at the position tail of the sweep. */
+    struct tSweepArc
+    {
+        tIndex tail;
+        double weight;
+    };
+
+    const ContractionHierarchy& m_rHierarchy;
+    RoutingContext m_context;
+    std::vector<tIndex> m_settled;
+
+    // the sweep order: the nodes by decreasing rank and the arcs into them
+    std::vector<tIndex> m_position;
+    std::vector<tIndex> m_firstArc;
+    std::vector<tSweepArc> m_arcs;
+
+    unsigned m_numSources;
+    std::vector<double> m_distances;    // m_numSources entries per position
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
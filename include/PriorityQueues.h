@@ -0,0 +1,325 @@
+#ifndef PRIORITYQUEUES_H
+#define PRIORITYQUEUES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/*
+* The priority queue policies of DijkstraEngine::run(src, rQueue). A queue holds (distance, node)
+* entries and provides
+*   void reserve(tIndex numNodes)          makes room for the node indices of a graph
+*   void clear()                           removes all entries
+*   bool empty() const
+*   void push(tIndex node, double dist)    inserts the node or lowers its distance
+*   tHeapEntry pop()                       removes an entry with the smallest distance
+* A queue without decrease-key may return outdated entries, whose distance is larger than the
+* current one of the node. The search skips them.
+*
+* The methods are defined here, so that the search inlines them.
+*/
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A binary heap with lazy deletion, the queue of the other engines: push appends an entry, so the
+* heap grows up to one entry per relaxation.
+*/
+class BinaryHeapQueue
+{
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+
+    void reserve(tIndex) { }
+    void clear() { m_heap.clear(); }
+    bool empty() const { return m_heap.empty(); }
+    size_t size() const { return m_heap.size(); }
+
+    void push(tIndex node, double distance) {
+        m_heap.push_back(tHeapEntry(distance, node));
+        std::push_heap(m_heap.begin(), m_heap.end(), std::greater<tHeapEntry>());
+    }
+
+    tHeapEntry pop() {
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<tHeapEntry>());
+        tHeapEntry top = m_heap.back();
+        m_heap.pop_back();
+        return top;
+    }
+
+private:
+
+    std::vector<tHeapEntry> m_heap;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* An indexed 4-ary heap with decrease-key. Every node is at most once in the heap, so it holds at
+* most one entry per reached node and never returns outdated ones. The 4 children of an entry share
+* a cache line, and the tree is half as deep as a binary one.
+*/
+class QuaternaryHeapQueue
+{
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+
+    void reserve(tIndex numNodes) {
+        if (m_position.size() < numNodes) {
+            m_position.resize(numNodes, static_cast<tIndex>(NOT_IN_HEAP));
+        }
+    }
+
+    void clear() {
+        for (const tHeapEntry& rEntry : m_heap) {
+            m_position[rEntry.second] = NOT_IN_HEAP;
+        }
+        m_heap.clear();
+    }
+
+    bool empty() const { return m_heap.empty(); }
+    size_t size() const { return m_heap.size(); }
+
+    void push(tIndex node, double distance) {
+        tIndex position = m_position[node];
+        if (position == NOT_IN_HEAP) {
+            position = static_cast<tIndex>(m_heap.size());
+            m_heap.push_back(tHeapEntry(distance, node));
+        } else if (distance < m_heap[position].first) {
+            m_heap[position].first = distance;
+        } else {
+            return;
+        }
+        siftUp(position);
+    }
+
+    tHeapEntry pop() {
+        tHeapEntry top = m_heap[0];
+        m_position[top.second] = NOT_IN_HEAP;
+        tHeapEntry last = m_heap.back();
+        m_heap.pop_back();
+        if (!m_heap.empty()) {
+            m_heap[0] = last;
+            siftDown(0);
+        }
+        return top;
+    }
+
+private:
+
+    static const tIndex NOT_IN_HEAP = CsrGraph::INVALID_INDEX;
+
+    void siftUp(tIndex position) {
+        tHeapEntry entry = m_heap[position];
+        while (position > 0) {
+            tIndex parent = (position - 1) / 4;
+            if (m_heap[parent].first <= entry.first) {
+                break;
+            }
+            m_heap[position] = m_heap[parent];
+            m_position[m_heap[position].second] = position;
+            position = parent;
+        }
+        m_heap[position] = entry;
+        m_position[entry.second] = position;
+    }
+
+    void siftDown(tIndex position) {
+        tHeapEntry entry = m_heap[position];
+        size_t size = m_heap.size();
+        while (true) {
+            size_t first = 4 * static_cast<size_t>(position) + 1;
+            if (first >= size) {
+                break;
+            }
+            size_t best = first;
+            size_t end = std::min(first + 4, size);
+            for (size_t child = first + 1; child < end; child++) {
+                if (m_heap[child].first < m_heap[best].first) {
+                    best = child;
+                }
+            }
+            if (entry.first <= m_heap[best].first) {
+                break;
+            }
+            m_heap[position] = m_heap[best];
+            m_position[m_heap[position].second] = position;
+            position = static_cast<tIndex>(best);
+        }
+        m_heap[position] = entry;
+        m_position[entry.second] = position;
+    }
+
+    std::vector<tHeapEntry> m_heap;
+    std::vector<tIndex> m_position;     // per node, its index in m_heap or NOT_IN_HEAP
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A monotone radix heap on integer keys, the distances times scale rounded down.
+*
+* Bucket 0 holds the entries with the key of the last pop, bucket i > 0 the ones whose key first
+* differs from it in bit i - 1. A pop from an empty bucket 0 takes the smallest key of the first
+* non-empty bucket and spreads that bucket over the lower ones, so every entry moves at most 64
+* times. Dijkstra never pushes a key below the last pop, which the heap requires.
+*
+* Entries with the same key come out in any order. The search then relaxes a node again, if a
+* node of the same key improves it later, so the distances are still exact. This happens rarely,
+* if the weights times scale are large, and never, if they are integers.
+*/
+class RadixHeapQueue
+{
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+
+    explicit RadixHeapQueue(double scale = 1.0) : m_scale(scale), m_last(0), m_size(0) { }
+
+    void reserve(tIndex) { }
+
+    void clear() {
+        for (std::vector<tHeapEntry>& rBucket : m_buckets) {
+            rBucket.clear();
+        }
+        m_last = 0;
+        m_size = 0;
+    }
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    void push(tIndex node, double distance) {
+        m_buckets[getBucket(getKey(distance))].push_back(tHeapEntry(distance, node));
+        m_size += 1;
+    }
+
+    tHeapEntry pop() {
+        if (m_buckets[0].empty()) {
+            size_t i = 1;
+            while (m_buckets[i].empty()) {
+                i++;
+            }
+            std::vector<tHeapEntry>& rBucket = m_buckets[i];
+            uint64_t minKey = getKey(rBucket[0].first);
+            for (const tHeapEntry& rEntry : rBucket) {
+                minKey = std::min(minKey, getKey(rEntry.first));
+            }
+            m_last = minKey;
+            for (const tHeapEntry& rEntry : rBucket) {
+                m_buckets[getBucket(getKey(rEntry.first))].push_back(rEntry);
+            }
+            rBucket.clear();
+        }
+        tHeapEntry top = m_buckets[0].back();
+        m_buckets[0].pop_back();
+        m_size -= 1;
+        return top;
+    }
+
+private:
+
+    uint64_t getKey(double distance) const { return static_cast<uint64_t>(distance * m_scale); }
+
+    /** @return the bucket of key, keys below the last pop count as equal to it. */
+    size_t getBucket(uint64_t key) const {
+        uint64_t diff = key > m_last ? key ^ m_last : 0;
+        size_t bucket = 0;
+        for (size_t shift = 32; shift > 0; shift /= 2) {
+            if (diff >> shift) {
+                diff >>= shift;
+                bucket += shift;
+            }
+        }
+        return bucket + static_cast<size_t>(diff);
+    }
+
+    double m_scale;
+    uint64_t m_last;
+    size_t m_size;
+    std::vector<tHeapEntry> m_buckets[65];
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Dial's bucket queue for small integer weights: one bucket per integer key (distance times scale
+* rounded down), used as a ring of maxWeight * scale + 2 buckets. All keys in the queue lie within
+* that range above the last pop, so a push and an amortized pop are O(1).
+*
+* Like the RadixHeapQueue, it returns the entries of one key in any order, and the search relaxes
+* a node again if needed. It suits weights whose scaled maximum is small, e.g. up to a few
+* thousand.
+*/
+class DialQueue
+{
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+
+    /** Creates the ring for the largest weight of rGraph. */
+    explicit DialQueue(const CsrGraph& rGraph, double scale = 1.0) : m_scale(scale), m_current(0), m_size(0) {
+        double maxWeight = 0.0;
+        for (tIndex e = 0; e < rGraph.getNumEdges(); e++) {
+            maxWeight = std::max(maxWeight, rGraph.getWeight(e));
+        }
+        m_buckets.resize(static_cast<size_t>(maxWeight * scale) + 2);
+    }
+
+    void reserve(tIndex) { }
+
+    void clear() {
+        for (std::vector<tHeapEntry>& rBucket : m_buckets) {
+            rBucket.clear();
+        }
+        m_current = 0;
+        m_size = 0;
+    }
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    void push(tIndex node, double distance) {
+        uint64_t key = std::max(m_current, static_cast<uint64_t>(distance * m_scale));
+        m_buckets[key % m_buckets.size()].push_back(tHeapEntry(distance, node));
+        m_size += 1;
+    }
+
+    tHeapEntry pop() {
+        while (m_buckets[m_current % m_buckets.size()].empty()) {
+            m_current++;
+        }
+        std::vector<tHeapEntry>& rBucket = m_buckets[m_current % m_buckets.size()];
+        tHeapEntry top = rBucket.back();
+        rBucket.pop_back();
+        m_size -= 1;
+        return top;
+    }
+
+    size_t getNumBuckets() const { return m_buckets.size(); }
+
+private:
+
+    double m_scale;
+    uint64_t m_current;     // the key of the last pop
+    size_t m_size;
+    std::vector<std::vector<tHeapEntry> > m_buckets;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
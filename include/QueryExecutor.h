@@ -0,0 +1,151 @@
+#ifndef QUERYEXECUTOR_H
+#define QUERYEXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* Runs batches of point to point queries on a CsrGraph concurrently, e.g. millions of (src, dst)
+* pairs of a batch job.
+*
+* A batch is split into tasks of consecutive queries, which are dealt out to the deques of the
+* worker threads. A worker takes the tasks of its own deque from the front and, once that is
+* empty, steals from the back of the others, so all workers stay busy until the last batch is
+* done, even if the queries of one part take much longer. Every worker has its own
+* RoutingContext, and the snapshot is only read, so the queries need no locks.
+*
+* submit() returns at once with a future, which becomes ready when all results of the batch are
+* written. Several batches, also from different threads, may be queued at the same time.
+*/
+class QueryExecutor
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /** The search that answers a query. */
+    enum tAlgorithm
+    {
+        // DijkstraEngine
+        ALGORITHM_DIJKSTRA,
+
+        // BidirectionalDijkstraEngine
+        ALGORITHM_BIDIRECTIONAL,
+
+        // AStarEngine with the HaversineHeuristic, for weights in km
+        ALGORITHM_ASTAR
+    };
+
+    struct tQuery
+    {
+        tIndex src;
+        tIndex dst;
+    };
+
+    /**
+    * Starts the workers. The snapshot must outlive the executor and must not change meanwhile.
+    * @param numThreads the number of workers, 0 for one per hardware thread.
+    */
+    explicit QueryExecutor(const CsrGraph& rGraph, unsigned numThreads = 0,
+                           tAlgorithm algorithm = ALGORITHM_BIDIRECTIONAL);
+
+    /** Finishes the queued batches and stops the workers. */
+    ~QueryExecutor();
+
+    /**
+    * Queues a batch. The arguments must stay alive and untouched until the future is ready.
+    * @param rDistances is resized to the number of queries and receives the distance of every
+    *        query or std::numeric_limits<double>::max(), if dst is unreachable.
+    * @param pPaths if not NULL, it is resized likewise and receives the original edges of every path.
+    * @return a future that is ready when the batch is done. If a query throws, the remaining
+    *         ones of the batch are skipped and the future rethrows the first exception.
+    * @throw Graph::InvalidNodeException if a query has a node index outside of the snapshot.
+    */
+    std::future<void> submit(const std::vector<tQuery>& rQueries, std::vector<double>& rDistances,
+                             std::vector<Graph::tEdges>* pPaths = NULL);
+
+    /** Runs a batch and waits for it, see submit. */
+    void run(const std::vector<tQuery>& rQueries, std::vector<double>& rDistances,
+             std::vector<Graph::tEdges>* pPaths = NULL) { submit(rQueries, rDistances, pPaths).get(); }
+
+    unsigned getNumThreads() const { return static_cast<unsigned>(m_workers.size()); }
+
+    /** @return the number of tasks that workers took from the deques of others so far. */
+    size_t getNumSteals() const { return m_numSteals.load(); }
+
+
+private:
+
+    /** A queued batch and its progress. */
+    struct tBatch
+    {
+        const std::vector<tQuery>* pQueries;
+        std::vector<double>* pDistances;
+        std::vector<Graph::tEdges>* pPaths;
+        std::atomic<size_t> numOpenTasks;
+        std::atomic<bool> failed;
+        std::exception_ptr pException;      // the first one, guarded by failed
+        std::promise<void> done;
+    };
+
+    /** The queries [begin, end) of a batch. */
+    struct tTask
+    {
+        std::shared_ptr<tBatch> pBatch;
+        size_t begin;
+        size_t end;
+    };
+
+    struct tWorker
+    {
+        std::mutex mutex;
+        std::deque<tTask> tasks;
+        std::unique_ptr<RoutingContext> pContext;   // created by the worker on its first query
+        std::thread thread;
+    };
+
+    QueryExecutor(const QueryExecutor&);
+    QueryExecutor& operator=(const QueryExecutor&);
+
+    void workerLoop(unsigned thread);
+
+    /** Takes a task from the own deque or steals one. @return false, if all deques are empty. */
+    bool takeTask(unsigned thread, tTask& rTask);
+
+    void runTask(unsigned thread, const tTask& rTask);
+
+    /** Answers one query on the context of the worker. */
+    void runQuery(RoutingContext& rContext, const tQuery& rQuery, double& rDistance, Graph::tEdges* pPath) const;
+
+    // the number of consecutive queries of a task
+    static const size_t TASK_SIZE = 16;
+
+    const CsrGraph& m_rGraph;
+    tAlgorithm m_algorithm;
+    std::vector<std::unique_ptr<tWorker> > m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::atomic<size_t> m_numQueued;    // tasks in the deques, changed with the deque locked
+    std::atomic<size_t> m_numSteals;
+    unsigned m_nextWorker;              // the deque for the next task, round robin
+    bool m_stop;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
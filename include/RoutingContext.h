@@ -0,0 +1,65 @@
+#ifndef ROUTINGCONTEXT_H
+#define ROUTINGCONTEXT_H
+
+#include <utility>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "SearchSpace.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The workspace of the routing engines: search spaces and priority queues for a forward and a
+* backward search.
+*
+* A context is meant to be kept per thread and reused for all queries. Its buffers are sized on
+* the first query and keep their capacity afterwards, so that repeated queries on the same
+* snapshot do not allocate. The engines (e.g. DijkstraEngine) work on a context that is passed
+* to them. A context must not be used by several threads at the same time.
+*/
+class RoutingContext
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+    typedef std::pair<double, tIndex> tHeapEntry;
+    typedef std::vector<tHeapEntry> tHeap;
+
+    RoutingContext() { }
+
+    /** Creates a context that is already sized for queries on rGraph. */
+    explicit RoutingContext(const CsrGraph& rGraph) { reserve(rGraph); }
+
+    /**
+    * Sizes the search spaces for rGraph, if they don't fit yet.
+    * @param withBackward sizes the backward space, too. Only bidirectional searches need it.
+    */
+    void reserve(const CsrGraph& rGraph, bool withBackward = false);
+
+    SearchSpace& getForwardSpace() { return m_forwardSpace; }
+    SearchSpace& getBackwardSpace() { return m_backwardSpace; }
+    const SearchSpace& getForwardSpace() const { return m_forwardSpace; }
+    const SearchSpace& getBackwardSpace() const { return m_backwardSpace; }
+
+    /** Binary min-heaps with lazy deletion, to be used with std::push_heap and std::greater. */
+    tHeap& getForwardHeap() { return m_forwardHeap; }
+    tHeap& getBackwardHeap() { return m_backwardHeap; }
+
+
+private:
+
+    RoutingContext(const RoutingContext&);
+    RoutingContext& operator=(const RoutingContext&);
+
+    SearchSpace m_forwardSpace;
+    SearchSpace m_backwardSpace;
+    tHeap m_forwardHeap;
+    tHeap m_backwardHeap;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef SEARCHSPACE_H
+#define SEARCHSPACE_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "CsrGraph.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The per node state of a graph search (distance, predecessor edge, reached / settled), stored in
+* a dense array that is addressed by the node index of a CsrGraph.
+*
+* The array is not reinitialized between searches. Every entry carries the number of the search
+* that wrote it, so clear() is O(1) and the cost of a search only depends on the nodes it touches.
+*/
+class SearchSpace
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    explicit SearchSpace(tIndex numNodes = 0);
+
+    /** Adapts the space to a graph with numNodes nodes. This clears the space. */
+    void resize(tIndex numNodes);
+
+    tIndex size() const { return static_cast<tIndex>(m_entries.size()); }
+
+    /** Starts a new search: all nodes become unreached. */
+    void clear();
+
+    /** @return true, if the node got a distance in the current search. */
+    bool isReached(tIndex node) const { return m_entries[node].stamp >= m_round; }
+
+    /** @return true, if the distance of the node is final in the current search. */
+    bool isSettled(tIndex node) const { return m_entries[node].stamp == m_round + 1; }
+
+    /** @return the tentative distance or std::numeric_limits<double>::max() if not reached. */
+    double getDistance(tIndex node) const {
+        return isReached(node) ? m_entries[node].distance : std::numeric_limits<double>::max();
+    }
+
+    /** @return the edge over which the node was reached or INVALID_INDEX. */
+    tIndex getPrevEdge(tIndex node) const {
+        return isReached(node) ? m_entries[node].prevEdge : CsrGraph::INVALID_INDEX;
+    }
+
+    /** Sets the tentative distance of a node and marks it as reached. */
+    void update(tIndex node, double distance, tIndex prevEdge) {
+        tEntry& rEntry = m_entries[node];
+        rEntry.distance = distance;
+        rEntry.prevEdge = prevEdge;
+        if (rEntry.stamp < m_round) {
+            rEntry.stamp = m_round;
+        }
+    }
+
+    /** Marks a reached node as settled. */
+    void settle(tIndex node) { m_entries[node].stamp = m_round + 1; }
+
+    /** @return the original edges from the source of the search to dst, empty if unreached. */
+    Graph::tPath getPath(const CsrGraph& rGraph, tIndex dst) const;
+
+    /** Like getPath above, but writes into rPath, which does not allocate if it has the capacity. */
+    void getPath(const CsrGraph& rGraph, tIndex dst, Graph::tEdges& rPath) const;
+
+
+private:
+
+    // all state of a node in one place, so that a relaxation touches one cache line
+    struct tEntry
+    {
+        double distance;
+        tIndex prevEdge;
+        uint32_t stamp;     // < m_round: unreached, m_round: reached, m_round + 1: settled
+    };
+
+    std::vector<tEntry> m_entries;
+    uint32_t m_round;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
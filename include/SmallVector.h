@@ -0,0 +1,142 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A contiguous vector that stores up to N elements inside the object itself.
+* Only when it grows beyond N, the elements are moved to the heap. This is meant for the
+* adjacency of nodes, which is small for most nodes of road networks.
+* The element type must be trivially copyable (e.g. pointers), elements are moved with memcpy.
+*/
+template<class T, size_t N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector requires trivially copyable elements");
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+public:
+
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    SmallVector() : m_pData(m_inline), m_size(0), m_capacity(N) { }
+
+    SmallVector(const SmallVector& rOther) : m_pData(m_inline), m_size(0), m_capacity(N) {
+        assign(rOther);
+    }
+
+    SmallVector(SmallVector&& rOther) : m_pData(m_inline), m_size(0), m_capacity(N) {
+        take(rOther);
+    }
+
+    ~SmallVector() { freeHeap(); }
+
+    SmallVector& operator=(const SmallVector& rOther) {
+        if (this != &rOther) {
+            m_size = 0;
+            assign(rOther);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rOther) {
+        if (this != &rOther) {
+            freeHeap();
+            take(rOther);
+        }
+        return *this;
+    }
+
+    iterator begin() { return m_pData; }
+    iterator end() { return m_pData + m_size; }
+    const_iterator begin() const { return m_pData; }
+    const_iterator end() const { return m_pData + m_size; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T& operator[](size_t i) { return m_pData[i]; }
+    const T& operator[](size_t i) const { return m_pData[i]; }
+    T& back() { return m_pData[m_size - 1]; }
+    const T& back() const { return m_pData[m_size - 1]; }
+
+    void push_back(const T& value) {
+        if (m_size == m_capacity) {
+            grow(2 * m_capacity);
+        }
+        m_pData[m_size++] = value;
+    }
+
+    void pop_back() { m_size -= 1; }
+
+    void clear() { m_size = 0; }
+
+    void reserve(size_t capacity) {
+        if (capacity > m_capacity) {
+            grow(capacity);
+        }
+    }
+
+
+private:
+
+    bool isInline() const { return m_pData == m_inline; }
+
+    void freeHeap() {
+        if (!isInline()) {
+            std::free(m_pData);
+        }
+    }
+
+    void grow(size_t capacity) {
+        T* pNew = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+        if (pNew == NULL) {
+            throw std::bad_alloc();
+        }
+        std::memcpy(pNew, m_pData, m_size * sizeof(T));
+        freeHeap();
+        m_pData = pNew;
+        m_capacity = static_cast<uint32_t>(capacity);
+    }
+
+    void assign(const SmallVector& rOther) {
+        reserve(rOther.m_size);
+        std::memcpy(m_pData, rOther.m_pData, rOther.m_size * sizeof(T));
+        m_size = rOther.m_size;
+    }
+
+    // takes over the elements of rOther and leaves it empty, freeHeap() must have been called.
+    void take(SmallVector& rOther) {
+        if (rOther.isInline()) {
+            m_pData = m_inline;
+            m_capacity = N;
+            std::memcpy(m_inline, rOther.m_inline, rOther.m_size * sizeof(T));
+        }
+        else {
+            m_pData = rOther.m_pData;
+            m_capacity = rOther.m_capacity;
+            rOther.m_pData = rOther.m_inline;
+            rOther.m_capacity = N;
+        }
+        m_size = rOther.m_size;
+        rOther.m_size = 0;
+    }
+
+    T* m_pData;
+    uint32_t m_size;
+    uint32_t m_capacity;
+    T m_inline[N];
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* A fixed set of worker threads for data parallel loops.
+*
+* parallelFor() hands out the indices of a loop in chunks to the workers and to the calling
+* thread, and returns when all of them are done. Every call gets the number of the thread that
+* runs it, so callers can keep per thread buffers (e.g. one RoutingContext per thread) in a
+* vector of getNumThreads() entries.
+*
+* Only one thread may call parallelFor() at a time, and the loop body must not call it again.
+*/
+class ThreadPool
+{
+
+public:
+
+    typedef std::function<void(size_t index, unsigned thread)> tLoopBody;
+
+    /**
+    * Starts numThreads - 1 workers, the calling thread is the remaining one.
+    * @param numThreads 0 uses one thread per hardware thread.
+    */
+    explicit ThreadPool(unsigned numThreads = 0);
+
+    ~ThreadPool();
+
+    /** @return the number of threads that run a loop, including the calling thread. */
+    unsigned getNumThreads() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    /**
+    * Calls body(i, thread) for every i in [0, n), with thread in [0, getNumThreads()).
+    * If a call throws, the remaining chunks are skipped and the first exception is rethrown.
+    * @param grainSize the number of consecutive indices that one thread takes at a time.
+    */
+    void parallelFor(size_t n, const tLoopBody& body, size_t grainSize = 16);
+
+
+private:
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void workerLoop(unsigned thread);
+
+    /** Runs chunks of the current loop until none are left. */
+    void work(unsigned thread);
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_done;
+    unsigned m_generation;      // counts the loops, so that workers notice a new one
+    unsigned m_numBusy;         // workers that have not finished the current loop
+    bool m_stop;
+
+    // the current loop
+    const tLoopBody* m_pBody;
+    size_t m_size;
+    size_t m_grainSize;
+    std::atomic<size_t> m_next;
+    std::exception_ptr m_pException;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
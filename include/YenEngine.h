@@ -0,0 +1,119 @@
+#ifndef YENENGINE_H
+#define YENENGINE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CsrGraph.h"
+#include "RoutingContext.h"
+#include "ThreadPool.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The k shortest loopless paths between two nodes of a CsrGraph with Yen's algorithm.
+*
+* Every accepted path is split at each of its nodes into a root path and a spur node. A spur
+* search finds the shortest path from the spur node to the target that neither visits a node of
+* the root path nor leaves the spur node over an edge that an accepted path with the same root
+* takes. Root path plus spur path is a candidate, and the cheapest candidate becomes the next path.
+*
+* The engine makes this cheaper in several ways:
+* - A backward search from the target computes the shortest path tree into it once per query.
+*   If the tree path of a spur node avoids the root and the banned edges, it is the spur path
+*   without a search. Otherwise the tree distances guide the spur search as an exact A* heuristic.
+* - The spur searches of a path are skipped or stopped early, once they cannot beat the
+*   candidates that will be accepted anyway.
+* - The spur searches of a path run in parallel, every thread on its own workspace, which is
+*   kept for later queries.
+*/
+class YenEngine
+{
+
+public:
+
+    typedef CsrGraph::tIndex tIndex;
+
+    /**
+    * Creates an engine with its own threads and workspaces.
+    * @param numThreads the number of threads for the spur searches, 0 for one per hardware thread.
+    */
+    explicit YenEngine(const CsrGraph& rGraph, unsigned numThreads = 0);
+
+    /**
+    * Calculates up to k shortest loopless paths from src to dst.
+    * @return the number of paths found, less than k if there are no more.
+    */
+    size_t run(tIndex src, tIndex dst, size_t k);
+
+    /** @return the number of paths of the last run. They are sorted by cost. */
+    size_t getNumPaths() const { return m_paths.size(); }
+
+    /** @return the cost of the i-th path of the last run. */
+    double getCost(size_t i) const { return m_costs[i]; }
+
+    /** @return the original edges of the i-th path of the last run. */
+    Graph::tPath getPath(size_t i) const;
+
+    /** Writes the original edges of the i-th path of the last run into rPath. */
+    void getPath(size_t i, Graph::tEdges& rPath) const;
+
+    /** @return the number of spur searches of the last run that the shortest path tree did not answer. */
+    size_t getNumSpurSearches() const;
+
+    const CsrGraph& getGraph() const { return m_rGraph; }
+
+
+private:
+
+    /** The state of the spur searches of one thread. */
+    struct tWorkspace
+    {
+        RoutingContext context;
+        std::vector<uint32_t> bannedNode;   // == stamp for the nodes of the current root path
+        std::vector<uint32_t> bannedEdge;   // == stamp for the edges that the spur search must not take
+        uint32_t stamp;
+        size_t numSearches;
+    };
+
+    /** A candidate path as edge indices. */
+    struct tCandidate
+    {
+        double cost;
+        std::vector<tIndex> edges;
+    };
+
+    YenEngine(const YenEngine&);
+    YenEngine& operator=(const YenEngine&);
+
+    /** Computes the shortest path tree into dst with a backward search. */
+    void buildTree(tIndex dst);
+
+    /** @return the distance from node to the target of the current query or std::numeric_limits<double>::max(). */
+    double getTreeDistance(tIndex node) const { return m_treeContext.getBackwardSpace().getDistance(node); }
+
+    /**
+    * Calculates the candidate that deviates from the accepted path at its i-th node. The result is
+    * empty, if there is none or if it would not cost less than limit.
+    */
+    void findSpur(const std::vector<tIndex>& rPath, size_t i, double limit, tWorkspace& rWorkspace,
+                  tCandidate& rResult) const;
+
+    double getCost(const std::vector<tIndex>& rEdges) const;
+
+    const CsrGraph& m_rGraph;
+    ThreadPool m_pool;
+    std::vector<std::unique_ptr<tWorkspace> > m_workspaces;
+    RoutingContext m_treeContext;
+    tIndex m_dst;
+
+    std::vector<std::vector<tIndex> > m_paths;
+    std::vector<double> m_costs;
+    std::vector<tCandidate> m_spurs;
+};
+
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,24 @@
+#include "../include/AStarEngine.h"
+
+constexpr double HaversineHeuristic::DEG_TO_RAD;
+constexpr double HaversineHeuristic::EARTH_RADIUS_KM;
+
+
+//-------------------------------------------------------------------------------------------------
+
+AStarEngine::AStarEngine(const CsrGraph& rGraph)
+    : m_rGraph(rGraph), m_pOwnContext(new RoutingContext(rGraph)), m_rContext(*m_pOwnContext), m_numSettled(0)
+{
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+AStarEngine::AStarEngine(const CsrGraph& rGraph, RoutingContext& rContext)
+    : m_rGraph(rGraph), m_rContext(rContext), m_numSettled(0)
+{
+    m_rContext.reserve(rGraph);
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,296 @@
+#include "../include/AlternativeRouteEngine.h"
+#include "../include/BidirectionalDijkstraEngine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+//-------------------------------------------------------------------------------------------------
+
+AlternativeRouteEngine::AlternativeRouteEngine(const CsrGraph& rGraph, const tOptions& rOptions)
+    : m_rGraph(rGraph), m_options(rOptions), m_stamp(0), m_visitStamp(0), m_numTests(0)
+{
+    m_context.reserve(rGraph, true);
+    m_testContext.reserve(rGraph, true);
+    for (int i = 0; i < 2; i++) {
+        m_sharing[i].resize(rGraph.getNumNodes());
+        m_plateau[i].resize(rGraph.getNumNodes());
+    }
+    m_plateauStart.resize(rGraph.getNumNodes());
+    m_onRoute.resize(rGraph.getNumEdges(), 0);
+    m_nodeOnRoute.resize(rGraph.getNumNodes(), 0);
+    m_visited.resize(rGraph.getNumNodes(), 0);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t AlternativeRouteEngine::run(tIndex src, tIndex dst)
+{
+    m_routes.clear();
+    m_costs.clear();
+    m_numTests = 0;
+    if (++m_stamp == 0) {
+        std::fill(m_onRoute.begin(), m_onRoute.end(), 0);
+        std::fill(m_nodeOnRoute.begin(), m_nodeOnRoute.end(), 0);
+        m_stamp = 1;
+    }
+
+    // the forward tree stops at the cost bound of the alternatives, which is known once dst is settled
+    double maxDistance = growTree(src, true, std::numeric_limits<double>::max(), dst);
+    const SearchSpace& rForward = m_context.getForwardSpace();
+    if (!rForward.isSettled(dst)) {
+        return 0;
+    }
+    double distance = rForward.getDistance(dst);
+    growTree(dst, false, maxDistance, CsrGraph::INVALID_INDEX);
+    const SearchSpace& rBackward = m_context.getBackwardSpace();
+
+    std::vector<tIndex> edges;
+    for (tIndex v = dst; v != src; v = m_rGraph.getTail(edges.back())) {
+        edges.push_back(rForward.getPrevEdge(v));
+    }
+    std::reverse(edges.begin(), edges.end());
+    accept(edges);
+    if (src == dst) {
+        return m_routes.size();
+    }
+
+    tagTree(true);
+    tagTree(false);
+
+    // rank the via nodes that pass the bounds of the trees, one per plateau
+    double maxSharing = m_options.maxSharing * distance;
+    std::vector<tCandidate> candidates;
+    if (++m_visitStamp == 0) {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        m_visitStamp = 1;
+    }
+    for (tIndex v : m_settled[0]) {
+        if (!rBackward.isSettled(v) || m_nodeOnRoute[v] == m_stamp
+            || m_visited[m_plateauStart[v]] == m_visitStamp) {
+            continue;
+        }
+        m_visited[m_plateauStart[v]] = m_visitStamp;
+        double cost = rForward.getDistance(v) + rBackward.getDistance(v);
+        double sharing = m_sharing[0][v] + m_sharing[1][v];
+        if (cost <= maxDistance && sharing <= maxSharing) {
+            tCandidate candidate = { 2 * cost + sharing - m_plateau[0][v] - m_plateau[1][v], v };
+            candidates.push_back(candidate);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // check the best candidates exactly against the routes chosen so far
+    for (const tCandidate& rCandidate : candidates) {
+        if (m_routes.size() > m_options.maxAlternatives) {
+            break;
+        }
+        tIndex v = rCandidate.node;
+        if (m_nodeOnRoute[v] == m_stamp || !buildViaPath(v, edges)) {
+            continue;
+        }
+
+        double sharing = 0.0;
+        size_t viaPosition = 0;
+        for (size_t i = 0; i < edges.size(); i++) {
+            sharing += (m_onRoute[edges[i]] == m_stamp) ? m_rGraph.getWeight(edges[i]) : 0.0;
+            viaPosition = (m_rGraph.getHead(edges[i]) == v) ? i + 1 : viaPosition;
+        }
+        if (sharing <= maxSharing && isLocallyOptimal(edges, v, viaPosition, distance)) {
+            accept(edges);
+        }
+    }
+
+    return m_routes.size();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+double AlternativeRouteEngine::growTree(tIndex root, bool forward, double maxDistance, tIndex stretchAt)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = forward ? m_context.getForwardSpace() : m_context.getBackwardSpace();
+    RoutingContext::tHeap& rHeap = forward ? m_context.getForwardHeap() : m_context.getBackwardHeap();
+    std::vector<tIndex>& rSettled = m_settled[forward ? 0 : 1];
+    rSpace.clear();
+    rHeap.clear();
+    rSettled.clear();
+
+    rSpace.update(root, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(0.0, root));
+
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tIndex u = rHeap.back().second;
+        rHeap.pop_back();
+        if (rSpace.isSettled(u)) {
+            continue;
+        }
+        rSpace.settle(u);
+        rSettled.push_back(u);
+
+        double distU = rSpace.getDistance(u);
+        if (u == stretchAt) {
+            maxDistance = (1.0 + m_options.maxStretch) * distU;
+        }
+
+        tIndex end = forward ? m_rGraph.firstOut(u + 1) : m_rGraph.firstIn(u + 1);
+        for (tIndex i = forward ? m_rGraph.firstOut(u) : m_rGraph.firstIn(u); i < end; i++) {
+            tIndex e = forward ? i : m_rGraph.getInEdge(i);
+            tIndex v = forward ? m_rGraph.getHead(e) : m_rGraph.getTail(e);
+            double newDistance = distU + m_rGraph.getWeight(e);
+            if (newDistance < rSpace.getDistance(v) && newDistance <= maxDistance) {
+                rSpace.update(v, newDistance, e);
+                rHeap.push_back(tHeapEntry(newDistance, v));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+
+    return maxDistance;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void AlternativeRouteEngine::tagTree(bool forward)
+{
+    const SearchSpace& rSpace = forward ? m_context.getForwardSpace() : m_context.getBackwardSpace();
+    const SearchSpace& rOther = forward ? m_context.getBackwardSpace() : m_context.getForwardSpace();
+    std::vector<double>& rSharing = m_sharing[forward ? 0 : 1];
+    std::vector<double>& rPlateau = m_plateau[forward ? 0 : 1];
+
+    // the parents of a node are settled before it, so one pass in settle order suffices. An edge
+    // belongs to a plateau, if the other tree takes it, too.
+    for (tIndex v : m_settled[forward ? 0 : 1]) {
+        tIndex e = rSpace.getPrevEdge(v);
+        if (e == CsrGraph::INVALID_INDEX) {
+            rSharing[v] = 0.0;
+            rPlateau[v] = 0.0;
+            m_plateauStart[v] = v;
+            continue;
+        }
+        tIndex parent = forward ? m_rGraph.getTail(e) : m_rGraph.getHead(e);
+        double weight = m_rGraph.getWeight(e);
+        rSharing[v] = rSharing[parent] + ((m_onRoute[e] == m_stamp) ? weight : 0.0);
+        bool onPlateau = rOther.isSettled(parent) && rOther.getPrevEdge(parent) == e;
+        rPlateau[v] = onPlateau ? rPlateau[parent] + weight : 0.0;
+        if (forward) {
+            m_plateauStart[v] = onPlateau ? m_plateauStart[parent] : v;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool AlternativeRouteEngine::buildViaPath(tIndex v, std::vector<tIndex>& rEdges)
+{
+    if (++m_visitStamp == 0) {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        m_visitStamp = 1;
+    }
+
+    const SearchSpace& rForward = m_context.getForwardSpace();
+    const SearchSpace& rBackward = m_context.getBackwardSpace();
+    rEdges.clear();
+    m_visited[v] = m_visitStamp;
+    for (tIndex u = v; rForward.getPrevEdge(u) != CsrGraph::INVALID_INDEX; ) {
+        rEdges.push_back(rForward.getPrevEdge(u));
+        u = m_rGraph.getTail(rEdges.back());
+        m_visited[u] = m_visitStamp;
+    }
+    std::reverse(rEdges.begin(), rEdges.end());
+
+    // the two halves may meet before v, then the via path has a loop
+    for (tIndex u = v; rBackward.getPrevEdge(u) != CsrGraph::INVALID_INDEX; ) {
+        rEdges.push_back(rBackward.getPrevEdge(u));
+        u = m_rGraph.getHead(rEdges.back());
+        if (m_visited[u] == m_visitStamp) {
+            return false;
+        }
+        m_visited[u] = m_visitStamp;
+    }
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool AlternativeRouteEngine::isLocallyOptimal(const std::vector<tIndex>& rEdges, tIndex v, size_t viaPosition,
+                                              double distance)
+{
+    // the subpath reaches at least T before and after the via node, or up to the ends of the path
+    double t = m_options.localOptimality * distance;
+    size_t first = viaPosition, last = viaPosition;
+    double before = 0.0, after = 0.0;
+    while (first > 0 && before < t) {
+        before += m_rGraph.getWeight(rEdges[--first]);
+    }
+    while (last < rEdges.size() && after < t) {
+        after += m_rGraph.getWeight(rEdges[last++]);
+    }
+    // a plateau is a path of the forward tree, hence a shortest path
+    if (first == last || (m_plateau[0][v] >= before && m_plateau[1][v] >= after)) {
+        return true;
+    }
+
+    if (m_numTests >= m_options.maxTests) {
+        return false;
+    }
+    m_numTests += 1;
+
+    double length = 0.0;
+    for (size_t i = first; i < last; i++) {
+        length += m_rGraph.getWeight(rEdges[i]);
+    }
+    BidirectionalDijkstraEngine engine(m_rGraph, m_testContext);
+    engine.run(m_rGraph.getTail(rEdges[first]), m_rGraph.getHead(rEdges[last - 1]));
+    return engine.getDistance() >= length * (1.0 - 1e-12);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void AlternativeRouteEngine::accept(const std::vector<tIndex>& rEdges)
+{
+    double cost = 0.0;
+    for (tIndex e : rEdges) {
+        cost += m_rGraph.getWeight(e);
+        m_onRoute[e] = m_stamp;
+        m_nodeOnRoute[m_rGraph.getTail(e)] = m_stamp;
+        m_nodeOnRoute[m_rGraph.getHead(e)] = m_stamp;
+    }
+    m_routes.push_back(rEdges);
+    m_costs.push_back(cost);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath AlternativeRouteEngine::getPath(size_t i) const
+{
+    Graph::tPath path;
+    for (tIndex e : m_routes[i]) {
+        path.push_back(m_rGraph.getEdge(e));
+    }
+    return path;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void AlternativeRouteEngine::getPath(size_t i, Graph::tEdges& rPath) const
+{
+    rPath.clear();
+    for (tIndex e : m_routes[i]) {
+        rPath.push_back(m_rGraph.getEdge(e));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,147 @@
+#include "../include/BidirectionalDijkstraEngine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+//-------------------------------------------------------------------------------------------------
+
+BidirectionalDijkstraEngine::BidirectionalDijkstraEngine(const CsrGraph& rGraph)
+    : m_rGraph(rGraph), m_pOwnContext(new RoutingContext()), m_rContext(*m_pOwnContext),
+      m_distance(std::numeric_limits<double>::max()), m_meetingNode(CsrGraph::INVALID_INDEX), m_numSettled(0)
+{
+    m_rContext.reserve(rGraph, true);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+BidirectionalDijkstraEngine::BidirectionalDijkstraEngine(const CsrGraph& rGraph, RoutingContext& rContext)
+    : m_rGraph(rGraph), m_rContext(rContext),
+      m_distance(std::numeric_limits<double>::max()), m_meetingNode(CsrGraph::INVALID_INDEX), m_numSettled(0)
+{
+    m_rContext.reserve(rGraph, true);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool BidirectionalDijkstraEngine::run(tIndex src, tIndex dst)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    const double infinity = std::numeric_limits<double>::max();
+
+    RoutingContext::tHeap& rForwardHeap = m_rContext.getForwardHeap();
+    RoutingContext::tHeap& rBackwardHeap = m_rContext.getBackwardHeap();
+    m_rContext.getForwardSpace().clear();
+    m_rContext.getBackwardSpace().clear();
+    rForwardHeap.clear();
+    rBackwardHeap.clear();
+
+    m_distance = infinity;
+    m_meetingNode = CsrGraph::INVALID_INDEX;
+    m_numSettled = 0;
+
+    m_rContext.getForwardSpace().update(src, 0.0, CsrGraph::INVALID_INDEX);
+    rForwardHeap.push_back(tHeapEntry(0.0, src));
+    m_rContext.getBackwardSpace().update(dst, 0.0, CsrGraph::INVALID_INDEX);
+    rBackwardHeap.push_back(tHeapEntry(0.0, dst));
+
+    if (src == dst) {
+        m_distance = 0.0;
+        m_meetingNode = src;
+        return true;
+    }
+
+    while (true) {
+        // the heap tops are lower bounds for everything the searches can still find
+        double forwardMin = rForwardHeap.empty() ? infinity : rForwardHeap.front().first;
+        double backwardMin = rBackwardHeap.empty() ? infinity : rBackwardHeap.front().first;
+        if (forwardMin == infinity || backwardMin == infinity || forwardMin + backwardMin >= m_distance) {
+            break;
+        }
+
+        step(forwardMin <= backwardMin);
+    }
+
+    return m_meetingNode != CsrGraph::INVALID_INDEX;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void BidirectionalDijkstraEngine::step(bool forward)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = forward ? m_rContext.getForwardSpace() : m_rContext.getBackwardSpace();
+    const SearchSpace& rOtherSpace = forward ? m_rContext.getBackwardSpace() : m_rContext.getForwardSpace();
+    RoutingContext::tHeap& rHeap = forward ? m_rContext.getForwardHeap() : m_rContext.getBackwardHeap();
+
+    std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+    tIndex u = rHeap.back().second;
+    rHeap.pop_back();
+
+    // skip outdated heap entries
+    if (rSpace.isSettled(u)) {
+        return;
+    }
+    rSpace.settle(u);
+    m_numSettled += 1;
+
+    double distU = rSpace.getDistance(u);
+    tIndex begin = forward ? m_rGraph.firstOut(u) : m_rGraph.firstIn(u);
+    tIndex end = forward ? m_rGraph.firstOut(u + 1) : m_rGraph.firstIn(u + 1);
+    for (tIndex i = begin; i < end; i++) {
+        tIndex e = forward ? i : m_rGraph.getInEdge(i);
+        tIndex v = forward ? m_rGraph.getHead(e) : m_rGraph.getTail(e);
+        double newDistance = distU + m_rGraph.getWeight(e);
+        if (newDistance < rSpace.getDistance(v)) {
+            rSpace.update(v, newDistance, e);
+            rHeap.push_back(tHeapEntry(newDistance, v));
+            std::push_heap(rHeap.begin(), rHeap.end(), compare);
+
+            // a path over v, if the other search has reached v
+            if (rOtherSpace.isReached(v) && newDistance + rOtherSpace.getDistance(v) < m_distance) {
+                m_distance = newDistance + rOtherSpace.getDistance(v);
+                m_meetingNode = v;
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath BidirectionalDijkstraEngine::getPath() const
+{
+    Graph::tEdges edges;
+    getPath(edges);
+    return Graph::tPath(edges.begin(), edges.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void BidirectionalDijkstraEngine::getPath(Graph::tEdges& rPath) const
+{
+    rPath.clear();
+    if (m_meetingNode == CsrGraph::INVALID_INDEX) {
+        return;
+    }
+
+    // the forward search tree from the source to the meeting node
+    m_rContext.getForwardSpace().getPath(m_rGraph, m_meetingNode, rPath);
+
+    // the backward search tree leads from the meeting node to the target
+    const SearchSpace& rBackwardSpace = m_rContext.getBackwardSpace();
+    tIndex e = rBackwardSpace.getPrevEdge(m_meetingNode);
+    while (e != CsrGraph::INVALID_INDEX) {
+        rPath.push_back(m_rGraph.getEdge(e));
+        e = rBackwardSpace.getPrevEdge(m_rGraph.getHead(e));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
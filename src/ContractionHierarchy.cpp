@@ -0,0 +1,845 @@
+#include "../include/ContractionHierarchy.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "../include/ThreadPool.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+* The state of the preprocessing: the remaining graph with its shortcuts as adjacency lists of arc
+* ids, and one workspace for the witness searches per thread.
+*/
+class ContractionHierarchy::Contractor
+{
+
+public:
+
+    Contractor(const CsrGraph& rGraph, const tOptions& rOptions, std::vector<tArc>& rArcs);
+
+    /** Contracts one node at a time and writes the ranks into rRank. */
+    void run(std::vector<tIndex>& rRank);
+
+    /** Contracts independent sets of nodes in parallel and writes the ranks into rRank. */
+    void runParallel(ThreadPool& rPool, std::vector<tIndex>& rRank);
+
+    /** The arcs from node to nodes that were contracted after it, tSearchArc::node is the head. */
+    const std::vector<tSearchArc>& getOut(tIndex node) const { return m_out[node]; }
+
+    /** The arcs into node from nodes that were contracted after it, tSearchArc::node is the tail. */
+    const std::vector<tSearchArc>& getIn(tIndex node) const { return m_in[node]; }
+
+
+private:
+
+    struct tShortcut
+    {
+        tIndex tail;
+        tIndex head;
+        double weight;
+        tIndex child1;
+        tIndex child2;
+    };
+
+    /** The state of the witness searches of one thread. */
+    struct tWorkspace
+    {
+        SearchSpace space;
+        RoutingContext::tHeap heap;
+        std::vector<char> isTarget;
+        std::vector<tShortcut> shortcuts;
+    };
+
+    /** Adds an arc unless there is a parallel one that is not longer. A longer one is replaced. */
+    void addArc(tIndex tail, tIndex head, double weight, tIndex edge, tIndex child1, tIndex child2);
+
+    /** Fills rWork.shortcuts with the shortcuts that a contraction of v needs. */
+    void findShortcuts(tIndex v, tWorkspace& rWork) const;
+
+    /**
+    * A Dijkstra from src in the remaining graph without v and the excluded nodes. It stops at
+    * maxDistance or when numTargets nodes marked in rWork.isTarget are settled.
+    */
+    void findWitnesses(tIndex src, tIndex v, double maxDistance, size_t numTargets, tWorkspace& rWork) const;
+
+    /** @return the edge difference of v plus the number of its contracted neighbours. */
+    long computePriority(tIndex v, tWorkspace& rWork) const;
+
+    /** Appends the distinct neighbours of v to rNeighbours. */
+    void collectNeighbours(tIndex v, std::vector<tIndex>& rNeighbours) const;
+
+    /** @return true, if v is more important than u. */
+    bool isMoreImportant(tIndex v, tIndex u) const;
+
+    /** @return true, if all nodes within two hops of v are more important than v. */
+    bool isLocalMinimum(tIndex v) const;
+
+    /** Drops the arcs from and to contracted nodes from the lists of node. */
+    void prune(tIndex node);
+
+    const CsrGraph& m_rGraph;
+    const tOptions& m_rOptions;
+    std::vector<tArc>& m_rArcs;
+
+    // the adjacency lists hold the other node and the weight, so that the witness searches
+    // don't have to look up m_rArcs
+    std::vector<std::vector<tSearchArc> > m_out;
+    std::vector<std::vector<tSearchArc> > m_in;
+    std::vector<char> m_contracted;
+    std::vector<char> m_excluded;       // the independent set of the current parallel round
+    std::vector<uint32_t> m_numContractedNeighbours;
+    std::vector<long> m_priority;
+
+    std::vector<tWorkspace> m_workspaces;
+    std::vector<tIndex> m_neighbours;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+
+ContractionHierarchy::Contractor::Contractor(const CsrGraph& rGraph, const tOptions& rOptions, std::vector<tArc>& rArcs)
+    : m_rGraph(rGraph), m_rOptions(rOptions), m_rArcs(rArcs),
+      m_out(rGraph.getNumNodes()), m_in(rGraph.getNumNodes()),
+      m_contracted(rGraph.getNumNodes(), 0), m_excluded(rGraph.getNumNodes(), 0),
+      m_numContractedNeighbours(rGraph.getNumNodes(), 0), m_priority(rGraph.getNumNodes(), 0)
+{
+    m_rArcs.reserve(rGraph.getNumEdges());
+
+    // self loops are never part of a shortest path, of parallel edges only the shortest one is
+    for (tIndex e = 0; e < rGraph.getNumEdges(); e++) {
+        if (rGraph.getTail(e) != rGraph.getHead(e)) {
+            addArc(rGraph.getTail(e), rGraph.getHead(e), rGraph.getWeight(e), e,
+                   CsrGraph::INVALID_INDEX, CsrGraph::INVALID_INDEX);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::Contractor::run(std::vector<tIndex>& rRank)
+{
+    typedef std::pair<long, tIndex> tQueueEntry;
+    std::priority_queue<tQueueEntry, std::vector<tQueueEntry>, std::greater<tQueueEntry> > queue;
+
+    m_workspaces.resize(1);
+    tWorkspace& rWork = m_workspaces[0];
+    rWork.space.resize(m_rGraph.getNumNodes());
+    rWork.isTarget.assign(m_rGraph.getNumNodes(), 0);
+
+    tIndex numNodes = m_rGraph.getNumNodes();
+    for (tIndex v = 0; v < numNodes; v++) {
+        m_priority[v] = computePriority(v, rWork);
+        queue.push(tQueueEntry(m_priority[v], v));
+    }
+
+    rRank.assign(numNodes, CsrGraph::INVALID_INDEX);
+    tIndex nextRank = 0;
+
+    while (!queue.empty()) {
+        tIndex v = queue.top().second;
+        long key = queue.top().first;
+        queue.pop();
+
+        // skip outdated queue entries
+        if (m_contracted[v] || key != m_priority[v]) {
+            continue;
+        }
+
+        m_neighbours.clear();
+        collectNeighbours(v, m_neighbours);
+
+        findShortcuts(v, rWork);
+        m_contracted[v] = 1;
+        rRank[v] = nextRank++;
+        for (const tShortcut& rShortcut : rWork.shortcuts) {
+            addArc(rShortcut.tail, rShortcut.head, rShortcut.weight, CsrGraph::INVALID_INDEX,
+                   rShortcut.child1, rShortcut.child2);
+        }
+
+        for (tIndex u : m_neighbours) {
+            m_numContractedNeighbours[u] += 1;
+            prune(u);
+            m_priority[u] = computePriority(u, rWork);
+            queue.push(tQueueEntry(m_priority[u], u));
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::Contractor::runParallel(ThreadPool& rPool, std::vector<tIndex>& rRank)
+{
+    typedef std::pair<tIndex, tShortcut> tBufferEntry;
+
+    tIndex numNodes = m_rGraph.getNumNodes();
+    unsigned numThreads = rPool.getNumThreads();
+
+    m_workspaces.resize(numThreads);
+    for (tWorkspace& rWork : m_workspaces) {
+        rWork.space.resize(numNodes);
+        rWork.isTarget.assign(numNodes, 0);
+    }
+
+    // the shortcuts of a round, tagged with the position of their node in the set
+    std::vector<std::vector<tBufferEntry> > buffers(numThreads);
+    std::vector<tBufferEntry> merged;
+
+    std::vector<tIndex> remaining(numNodes);
+    for (tIndex v = 0; v < numNodes; v++) {
+        remaining[v] = v;
+    }
+    rPool.parallelFor(numNodes, [&](size_t i, unsigned thread) {
+        m_priority[i] = computePriority(static_cast<tIndex>(i), m_workspaces[thread]);
+    });
+
+    rRank.assign(numNodes, CsrGraph::INVALID_INDEX);
+    tIndex nextRank = 0;
+    std::vector<char> selected(numNodes, 0);
+    std::vector<tIndex> set;
+
+    while (!remaining.empty()) {
+        rPool.parallelFor(remaining.size(), [&](size_t i, unsigned) {
+            selected[remaining[i]] = isLocalMinimum(remaining[i]) ? 1 : 0;
+        }, 256);
+
+        set.clear();
+        for (tIndex v : remaining) {
+            if (selected[v]) {
+                set.push_back(v);
+                m_excluded[v] = 1;
+            }
+        }
+
+        // the witness searches of the whole set run on the graph before the round
+        for (std::vector<tBufferEntry>& rBuffer : buffers) {
+            rBuffer.clear();
+        }
+        rPool.parallelFor(set.size(), [&](size_t i, unsigned thread) {
+            tWorkspace& rWork = m_workspaces[thread];
+            findShortcuts(set[i], rWork);
+            for (const tShortcut& rShortcut : rWork.shortcuts) {
+                buffers[thread].push_back(tBufferEntry(static_cast<tIndex>(i), rShortcut));
+            }
+        });
+
+        // every node was handled by one thread, so sorting by position gives the same order for
+        // any number of threads
+        merged.clear();
+        for (const std::vector<tBufferEntry>& rBuffer : buffers) {
+            merged.insert(merged.end(), rBuffer.begin(), rBuffer.end());
+        }
+        std::stable_sort(merged.begin(), merged.end(),
+                         [](const tBufferEntry& a, const tBufferEntry& b) { return a.first < b.first; });
+
+        for (tIndex v : set) {
+            m_contracted[v] = 1;
+            m_excluded[v] = 0;
+            rRank[v] = nextRank++;
+        }
+        for (const tBufferEntry& rEntry : merged) {
+            const tShortcut& rShortcut = rEntry.second;
+            addArc(rShortcut.tail, rShortcut.head, rShortcut.weight, CsrGraph::INVALID_INDEX,
+                   rShortcut.child1, rShortcut.child2);
+        }
+
+        m_neighbours.clear();
+        for (tIndex v : set) {
+            collectNeighbours(v, m_neighbours);
+        }
+        for (tIndex u : m_neighbours) {
+            m_numContractedNeighbours[u] += 1;
+        }
+        std::sort(m_neighbours.begin(), m_neighbours.end());
+        m_neighbours.erase(std::unique(m_neighbours.begin(), m_neighbours.end()), m_neighbours.end());
+
+        for (tIndex u : m_neighbours) {
+            prune(u);
+        }
+        rPool.parallelFor(m_neighbours.size(), [&](size_t i, unsigned thread) {
+            tIndex u = m_neighbours[i];
+            m_priority[u] = computePriority(u, m_workspaces[thread]);
+        });
+
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+                                       [&](tIndex v) { return m_contracted[v] != 0; }),
+                        remaining.end());
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::Contractor::addArc(tIndex tail, tIndex head, double weight, tIndex edge,
+                                              tIndex child1, tIndex child2)
+{
+    tArc arc = { tail, head, weight, edge, child1, child2 };
+    tIndex id = static_cast<tIndex>(m_rArcs.size());
+
+    tSearchArc out = { head, id, weight };
+    tSearchArc in = { tail, id, weight };
+
+    std::vector<tSearchArc>& rOut = m_out[tail];
+    for (tSearchArc& rExisting : rOut) {
+        if (rExisting.node != head) {
+            continue;
+        }
+        if (rExisting.weight <= weight) {
+            return;
+        }
+
+        // the replaced arc stays in m_rArcs, older shortcuts may still consist of it
+        for (tSearchArc& rExistingIn : m_in[head]) {
+            if (rExistingIn.arc == rExisting.arc) {
+                rExistingIn = in;
+                break;
+            }
+        }
+        rExisting = out;
+        m_rArcs.push_back(arc);
+        return;
+    }
+
+    rOut.push_back(out);
+    m_in[head].push_back(in);
+    m_rArcs.push_back(arc);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::Contractor::findShortcuts(tIndex v, tWorkspace& rWork) const
+{
+    rWork.shortcuts.clear();
+
+    for (const tSearchArc& rIn : m_in[v]) {
+        tIndex u = rIn.node;
+
+        double maxDistance = 0.0;
+        size_t numTargets = 0;
+        for (const tSearchArc& rOut : m_out[v]) {
+            if (rOut.node != u) {
+                maxDistance = std::max(maxDistance, rIn.weight + rOut.weight);
+                numTargets += 1;
+                rWork.isTarget[rOut.node] = 1;
+            }
+        }
+
+        findWitnesses(u, v, maxDistance, numTargets, rWork);
+        for (const tSearchArc& rOut : m_out[v]) {
+            rWork.isTarget[rOut.node] = 0;
+        }
+
+        // a shortcut is needed, if no path without v is as short as the one over v
+        for (const tSearchArc& rOut : m_out[v]) {
+            tIndex w = rOut.node;
+            double distance = rIn.weight + rOut.weight;
+            if (w != u && rWork.space.getDistance(w) > distance) {
+                tShortcut shortcut = { u, w, distance, rIn.arc, rOut.arc };
+                rWork.shortcuts.push_back(shortcut);
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::Contractor::findWitnesses(tIndex src, tIndex v, double maxDistance, size_t numTargets,
+                                                     tWorkspace& rWork) const
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = rWork.space;
+    RoutingContext::tHeap& rHeap = rWork.heap;
+    rSpace.clear();
+    rHeap.clear();
+
+    rSpace.update(src, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(0.0, src));
+
+    size_t numSettled = 0;
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tHeapEntry top = rHeap.back();
+        rHeap.pop_back();
+
+        if (top.first > maxDistance || numSettled >= m_rOptions.maxWitnessSettled || numTargets == 0) {
+            break;
+        }
+        if (rSpace.isSettled(top.second)) {
+            continue;
+        }
+        rSpace.settle(top.second);
+        numSettled += 1;
+        numTargets -= rWork.isTarget[top.second];
+
+        // nodes that are contracted in the same round can't be witnesses for each other
+        for (const tSearchArc& rArc : m_out[top.second]) {
+            tIndex w = rArc.node;
+            double newDistance = top.first + rArc.weight;
+            if (w != v && !m_excluded[w] && newDistance < rSpace.getDistance(w)) {
+                rSpace.update(w, newDistance, rArc.arc);
+                rHeap.push_back(tHeapEntry(newDistance, w));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+long ContractionHierarchy::Contractor::computePriority(tIndex v, tWorkspace& rWork) const
+{
+    findShortcuts(v, rWork);
+
+    long edgeDifference = static_cast<long>(rWork.shortcuts.size())
+                        - static_cast<long>(m_out[v].size() + m_in[v].size());
+
+    // contracted neighbours spread the contraction evenly over the graph
+    return edgeDifference + m_numContractedNeighbours[v];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::Contractor::collectNeighbours(tIndex v, std::vector<tIndex>& rNeighbours) const
+{
+    size_t begin = rNeighbours.size();
+    for (const tSearchArc& rArc : m_out[v]) {
+        rNeighbours.push_back(rArc.node);
+    }
+    for (const tSearchArc& rArc : m_in[v]) {
+        rNeighbours.push_back(rArc.node);
+    }
+    std::sort(rNeighbours.begin() + begin, rNeighbours.end());
+    rNeighbours.erase(std::unique(rNeighbours.begin() + begin, rNeighbours.end()), rNeighbours.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool ContractionHierarchy::Contractor::isMoreImportant(tIndex v, tIndex u) const
+{
+    // ties are broken by the index like in the sequential order. Imported graphs number their
+    // nodes along the roads, and a random tie breaking costs many more shortcuts on them.
+    if (m_priority[v] != m_priority[u]) {
+        return m_priority[v] > m_priority[u];
+    }
+    return v > u;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool ContractionHierarchy::Contractor::isLocalMinimum(tIndex v) const
+{
+    // two hops instead of one keep the nodes of a round apart, so that they rarely lie on each
+    // other's witness paths, which would cost extra shortcuts
+    for (int direction = 0; direction < 2; direction++) {
+        for (const tSearchArc& rArc : direction == 0 ? m_out[v] : m_in[v]) {
+            tIndex u = rArc.node;
+            if (!isMoreImportant(u, v)) {
+                return false;
+            }
+            for (const tSearchArc& rSecond : m_out[u]) {
+                if (rSecond.node != v && !isMoreImportant(rSecond.node, v)) {
+                    return false;
+                }
+            }
+            for (const tSearchArc& rSecond : m_in[u]) {
+                if (rSecond.node != v && !isMoreImportant(rSecond.node, v)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::Contractor::prune(tIndex node)
+{
+    const std::vector<char>& rContracted = m_contracted;
+    auto isContracted = [&](const tSearchArc& rArc) { return rContracted[rArc.node] != 0; };
+
+    std::vector<tSearchArc>& rOut = m_out[node];
+    rOut.erase(std::remove_if(rOut.begin(), rOut.end(), isContracted), rOut.end());
+
+    std::vector<tSearchArc>& rIn = m_in[node];
+    rIn.erase(std::remove_if(rIn.begin(), rIn.end(), isContracted), rIn.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+ContractionHierarchy::ContractionHierarchy(const CsrGraph& rGraph, const tOptions& rOptions)
+    : m_rGraph(rGraph), m_numShortcuts(0)
+{
+    tIndex numNodes = rGraph.getNumNodes();
+
+    Contractor contractor(rGraph, rOptions, m_arcs);
+    if (rOptions.numThreads == 1) {
+        contractor.run(m_rank);
+    } else {
+        ThreadPool pool(rOptions.numThreads);
+        contractor.runParallel(pool, m_rank);
+    }
+
+    // when a node is contracted, its lists only hold arcs from and to higher ranked nodes
+    m_firstUp.assign(numNodes + 1, 0);
+    m_firstDown.assign(numNodes + 1, 0);
+    for (tIndex v = 0; v < numNodes; v++) {
+        m_firstUp[v + 1] = m_firstUp[v] + static_cast<tIndex>(contractor.getOut(v).size());
+        m_firstDown[v + 1] = m_firstDown[v] + static_cast<tIndex>(contractor.getIn(v).size());
+    }
+
+    m_up.reserve(m_firstUp[numNodes]);
+    m_down.reserve(m_firstDown[numNodes]);
+    for (tIndex v = 0; v < numNodes; v++) {
+        m_up.insert(m_up.end(), contractor.getOut(v).begin(), contractor.getOut(v).end());
+        m_down.insert(m_down.end(), contractor.getIn(v).begin(), contractor.getIn(v).end());
+    }
+    for (const tSearchArc& rUp : m_up) {
+        m_numShortcuts += (m_arcs[rUp.arc].edge == CsrGraph::INVALID_INDEX) ? 1 : 0;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::unpackArc(tIndex arc, Graph::tEdges& rPath) const
+{
+    // the nesting depth is bounded by the number of ranks between tail and head
+    const tArc& rArc = m_arcs[arc];
+    if (rArc.edge != CsrGraph::INVALID_INDEX) {
+        rPath.push_back(m_rGraph.getEdge(rArc.edge));
+    } else {
+        unpackArc(rArc.child1, rPath);
+        unpackArc(rArc.child2, rPath);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath ContractionHierarchy::findShortestPath(const Node& rSrc, const Node& rDst) const
+{
+    CHQueryEngine engine(*this);
+    engine.run(m_rGraph.getIndex(rSrc), m_rGraph.getIndex(rDst));
+    return engine.getPath();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool ContractionHierarchy::findShortestPath(const Node& rSrc, const Node& rDst,
+                                            RoutingContext& rContext, Graph::tEdges& rPath) const
+{
+    CHQueryEngine engine(*this, rContext);
+    bool found = engine.run(m_rGraph.getIndex(rSrc), m_rGraph.getIndex(rDst));
+    engine.getPath(rPath);
+    return found;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::vector<double> ContractionHierarchy::computeDistanceMatrix(const std::vector<tIndex>& rSources,
+                                                                const std::vector<tIndex>& rTargets,
+                                                                unsigned numThreads) const
+{
+    struct tBucketEntry
+    {
+        tIndex node;
+        tIndex target;
+        double distance;
+    };
+
+    std::vector<double> matrix(rSources.size() * rTargets.size(), std::numeric_limits<double>::max());
+    if (matrix.empty()) {
+        return matrix;
+    }
+
+    ThreadPool pool(numThreads);
+    std::vector<std::unique_ptr<RoutingContext> > contexts(pool.getNumThreads());
+    std::vector<std::vector<tIndex> > settled(pool.getNumThreads());
+    for (std::unique_ptr<RoutingContext>& rpContext : contexts) {
+        rpContext.reset(new RoutingContext());
+    }
+
+    // the backward searches of every thread collect their bucket entries separately
+    std::vector<std::vector<tBucketEntry> > reached(pool.getNumThreads());
+    pool.parallelFor(rTargets.size(), [&](size_t j, unsigned thread) {
+        RoutingContext& rContext = *contexts[thread];
+        searchUpward(rTargets[j], false, rContext, settled[thread]);
+        for (tIndex node : settled[thread]) {
+            tBucketEntry entry = { node, static_cast<tIndex>(j), rContext.getForwardSpace().getDistance(node) };
+            reached[thread].push_back(entry);
+        }
+    }, 1);
+
+    // sort the entries into one bucket per node
+    std::vector<size_t> firstBucket(getNumNodes() + 1, 0);
+    for (const std::vector<tBucketEntry>& rReached : reached) {
+        for (const tBucketEntry& rEntry : rReached) {
+            firstBucket[rEntry.node + 1] += 1;
+        }
+    }
+    for (tIndex v = 0; v < getNumNodes(); v++) {
+        firstBucket[v + 1] += firstBucket[v];
+    }
+    std::vector<tBucketEntry> buckets(firstBucket.back());
+    std::vector<size_t> next(firstBucket.begin(), firstBucket.end() - 1);
+    for (std::vector<tBucketEntry>& rReached : reached) {
+        for (const tBucketEntry& rEntry : rReached) {
+            buckets[next[rEntry.node]++] = rEntry;
+        }
+        std::vector<tBucketEntry>().swap(rReached);
+    }
+
+    pool.parallelFor(rSources.size(), [&](size_t i, unsigned thread) {
+        RoutingContext& rContext = *contexts[thread];
+        searchUpward(rSources[i], true, rContext, settled[thread]);
+
+        double* pRow = &matrix[i * rTargets.size()];
+        for (tIndex node : settled[thread]) {
+            double distance = rContext.getForwardSpace().getDistance(node);
+            for (size_t k = firstBucket[node]; k < firstBucket[node + 1]; k++) {
+                pRow[buckets[k].target] = std::min(pRow[buckets[k].target], distance + buckets[k].distance);
+            }
+        }
+    }, 1);
+
+    return matrix;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ContractionHierarchy::searchUpward(tIndex root, bool forward, RoutingContext& rContext,
+                                        std::vector<tIndex>& rSettled) const
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    rContext.reserve(m_rGraph);
+    SearchSpace& rSpace = rContext.getForwardSpace();
+    RoutingContext::tHeap& rHeap = rContext.getForwardHeap();
+    rSpace.clear();
+    rHeap.clear();
+    rSettled.clear();
+
+    rSpace.update(root, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(0.0, root));
+
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tIndex u = rHeap.back().second;
+        rHeap.pop_back();
+
+        // skip outdated heap entries
+        if (rSpace.isSettled(u)) {
+            continue;
+        }
+        rSpace.settle(u);
+        double distU = rSpace.getDistance(u);
+
+        // stall on demand, see CHQueryEngine::step
+        bool isStalled = false;
+        tIndex stallBegin = forward ? firstDown(u) : firstUp(u);
+        tIndex stallEnd = forward ? firstDown(u + 1) : firstUp(u + 1);
+        for (tIndex i = stallBegin; i < stallEnd && !isStalled; i++) {
+            const tSearchArc& rArc = forward ? getDown(i) : getUp(i);
+            isStalled = rSpace.getDistance(rArc.node) + rArc.weight < distU;
+        }
+        if (isStalled) {
+            continue;
+        }
+        rSettled.push_back(u);
+
+        tIndex begin = forward ? firstUp(u) : firstDown(u);
+        tIndex end = forward ? firstUp(u + 1) : firstDown(u + 1);
+        for (tIndex i = begin; i < end; i++) {
+            const tSearchArc& rArc = forward ? getUp(i) : getDown(i);
+            double newDistance = distU + rArc.weight;
+            if (newDistance < rSpace.getDistance(rArc.node)) {
+                rSpace.update(rArc.node, newDistance, rArc.arc);
+                rHeap.push_back(tHeapEntry(newDistance, rArc.node));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CHQueryEngine::CHQueryEngine(const ContractionHierarchy& rHierarchy)
+    : m_rHierarchy(rHierarchy), m_pOwnContext(new RoutingContext()), m_rContext(*m_pOwnContext),
+      m_distance(std::numeric_limits<double>::max()), m_meetingNode(CsrGraph::INVALID_INDEX), m_numSettled(0)
+{
+    m_rContext.reserve(rHierarchy.getGraph(), true);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CHQueryEngine::CHQueryEngine(const ContractionHierarchy& rHierarchy, RoutingContext& rContext)
+    : m_rHierarchy(rHierarchy), m_rContext(rContext),
+      m_distance(std::numeric_limits<double>::max()), m_meetingNode(CsrGraph::INVALID_INDEX), m_numSettled(0)
+{
+    m_rContext.reserve(rHierarchy.getGraph(), true);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool CHQueryEngine::run(tIndex src, tIndex dst)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    const double infinity = std::numeric_limits<double>::max();
+
+    RoutingContext::tHeap& rForwardHeap = m_rContext.getForwardHeap();
+    RoutingContext::tHeap& rBackwardHeap = m_rContext.getBackwardHeap();
+    m_rContext.getForwardSpace().clear();
+    m_rContext.getBackwardSpace().clear();
+    rForwardHeap.clear();
+    rBackwardHeap.clear();
+
+    m_distance = infinity;
+    m_meetingNode = CsrGraph::INVALID_INDEX;
+    m_numSettled = 0;
+
+    m_rContext.getForwardSpace().update(src, 0.0, CsrGraph::INVALID_INDEX);
+    rForwardHeap.push_back(tHeapEntry(0.0, src));
+    m_rContext.getBackwardSpace().update(dst, 0.0, CsrGraph::INVALID_INDEX);
+    rBackwardHeap.push_back(tHeapEntry(0.0, dst));
+
+    while (true) {
+        // unlike plain bidirectional Dijkstra, both upward searches have to run until their
+        // minimum exceeds the best path, because the top node of a path may be settled late
+        double forwardMin = rForwardHeap.empty() ? infinity : rForwardHeap.front().first;
+        double backwardMin = rBackwardHeap.empty() ? infinity : rBackwardHeap.front().first;
+        bool forwardActive = forwardMin < m_distance;
+        bool backwardActive = backwardMin < m_distance;
+        if (!forwardActive && !backwardActive) {
+            break;
+        }
+
+        step(forwardActive && (!backwardActive || forwardMin <= backwardMin));
+    }
+
+    return m_meetingNode != CsrGraph::INVALID_INDEX;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void CHQueryEngine::step(bool forward)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    typedef ContractionHierarchy::tSearchArc tSearchArc;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = forward ? m_rContext.getForwardSpace() : m_rContext.getBackwardSpace();
+    const SearchSpace& rOtherSpace = forward ? m_rContext.getBackwardSpace() : m_rContext.getForwardSpace();
+    RoutingContext::tHeap& rHeap = forward ? m_rContext.getForwardHeap() : m_rContext.getBackwardHeap();
+
+    std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+    tIndex u = rHeap.back().second;
+    rHeap.pop_back();
+
+    // skip outdated heap entries
+    if (rSpace.isSettled(u)) {
+        return;
+    }
+    rSpace.settle(u);
+    m_numSettled += 1;
+
+    double distU = rSpace.getDistance(u);
+    if (rOtherSpace.isReached(u) && distU + rOtherSpace.getDistance(u) < m_distance) {
+        m_distance = distU + rOtherSpace.getDistance(u);
+        m_meetingNode = u;
+    }
+
+    // the arcs of this search and the ones of the other search, which lead into u from above
+    const ContractionHierarchy& rCH = m_rHierarchy;
+    tIndex begin = forward ? rCH.firstUp(u) : rCH.firstDown(u);
+    tIndex end = forward ? rCH.firstUp(u + 1) : rCH.firstDown(u + 1);
+    tIndex stallBegin = forward ? rCH.firstDown(u) : rCH.firstUp(u);
+    tIndex stallEnd = forward ? rCH.firstDown(u + 1) : rCH.firstUp(u + 1);
+
+    // stall on demand: u is not on a shortest path, if a higher node reaches it with less
+    for (tIndex i = stallBegin; i < stallEnd; i++) {
+        const tSearchArc& rArc = forward ? rCH.getDown(i) : rCH.getUp(i);
+        if (rSpace.getDistance(rArc.node) + rArc.weight < distU) {
+            return;
+        }
+    }
+
+    for (tIndex i = begin; i < end; i++) {
+        const tSearchArc& rArc = forward ? rCH.getUp(i) : rCH.getDown(i);
+        double newDistance = distU + rArc.weight;
+        if (newDistance < rSpace.getDistance(rArc.node)) {
+            rSpace.update(rArc.node, newDistance, rArc.arc);
+            rHeap.push_back(tHeapEntry(newDistance, rArc.node));
+            std::push_heap(rHeap.begin(), rHeap.end(), compare);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CHQueryEngine::getPath() const
+{
+    Graph::tEdges edges;
+    getPath(edges);
+    return Graph::tPath(edges.begin(), edges.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void CHQueryEngine::getPath(Graph::tEdges& rPath) const
+{
+    rPath.clear();
+    if (m_meetingNode == CsrGraph::INVALID_INDEX) {
+        return;
+    }
+
+    // the prevEdge entries of the search spaces are arcs of the hierarchy
+    const SearchSpace& rForwardSpace = m_rContext.getForwardSpace();
+    const SearchSpace& rBackwardSpace = m_rContext.getBackwardSpace();
+
+    // the forward arcs are found from the meeting node back to the source: every arc is unpacked
+    // and turned around, and finally the whole forward part is turned around
+    tIndex arc = rForwardSpace.getPrevEdge(m_meetingNode);
+    while (arc != CsrGraph::INVALID_INDEX) {
+        size_t begin = rPath.size();
+        m_rHierarchy.unpackArc(arc, rPath);
+        std::reverse(rPath.begin() + begin, rPath.end());
+        arc = rForwardSpace.getPrevEdge(m_rHierarchy.getArc(arc).tail);
+    }
+    std::reverse(rPath.begin(), rPath.end());
+
+    // the backward arcs lead from the meeting node to the target
+    arc = rBackwardSpace.getPrevEdge(m_meetingNode);
+    while (arc != CsrGraph::INVALID_INDEX) {
+        m_rHierarchy.unpackArc(arc, rPath);
+        arc = rBackwardSpace.getPrevEdge(m_rHierarchy.getArc(arc).head);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
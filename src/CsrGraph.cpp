@@ -0,0 +1,426 @@
+#include "../include/CsrGraph.h"
+#include "../include/DijkstraEngine.h"
+#include "../include/AStarEngine.h"
+#include "../include/AlternativeRouteEngine.h"
+#include "../include/BidirectionalDijkstraEngine.h"
+#include "../include/LandmarkTable.h"
+#include "../include/ThreadPool.h"
+#include "../include/YenEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <functional>
+
+const CsrGraph::tIndex CsrGraph::INVALID_INDEX;
+
+
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph::CsrGraph(Graph& rGraph, double weightUnit)
+    : m_weightUnit(std::max(weightUnit, 0.0)), m_metricNames(1, "weight"), m_pGraph(&rGraph)
+{
+    Graph::tNodePtrSet& rNodes = rGraph.getNodes();
+
+    // number the nodes densely in id order
+    m_nodes.reserve(rNodes.size());
+    m_lon.reserve(rNodes.size());
+    m_lat.reserve(rNodes.size());
+    m_indexByNode.reserve(rNodes.size());
+    for (Node* pNode : rNodes) {
+        m_indexByNode[pNode] = static_cast<tIndex>(m_nodes.size());
+        m_nodes.push_back(pNode);
+        m_lon.push_back(pNode->getLon());
+        m_lat.push_back(pNode->getLat());
+    }
+
+    size_t numEdges = rGraph.getEdges().size();
+    m_firstOut.reserve(m_nodes.size() + 1);
+    m_head.reserve(numEdges);
+    m_tail.reserve(numEdges);
+    m_weight.reserve(numEdges);
+    m_edges.reserve(numEdges);
+
+    // copy the out-edges of every node in their adjacency order
+    for (tIndex u = 0; u < m_nodes.size(); u++) {
+        m_firstOut.push_back(static_cast<tIndex>(m_head.size()));
+        for (Edge* pEdge : m_nodes[u]->getOutEdges()) {
+            m_head.push_back(getIndex(pEdge->getDstNode()));
+            m_tail.push_back(u);
+            m_weight.push_back(pEdge->getWeight());
+            m_edges.push_back(pEdge);
+        }
+    }
+    m_firstOut.push_back(static_cast<tIndex>(m_head.size()));
+
+    // group the edges by their head for the backward adjacency (counting sort)
+    m_firstIn.assign(m_nodes.size() + 1, 0);
+    for (tIndex head : m_head) {
+        m_firstIn[head + 1] += 1;
+    }
+    for (size_t v = 0; v < m_nodes.size(); v++) {
+        m_firstIn[v + 1] += m_firstIn[v];
+    }
+
+    m_inEdge.resize(m_head.size());
+    std::vector<tIndex> nextIn(m_firstIn.begin(), m_firstIn.end() - 1);
+    for (tIndex e = 0; e < m_head.size(); e++) {
+        m_inEdge[nextIn[m_head[e]]++] = e;
+    }
+
+    if (hasFixedWeights()) {
+        m_fixedArc.resize(m_head.size());
+        for (tIndex e = 0; e < m_head.size(); e++) {
+            double units = std::floor(m_weight[e] / m_weightUnit + 0.5);
+            if (!(units >= 0.0 && units <= std::numeric_limits<uint32_t>::max())) {
+                throw Graph::Exception("edge weight exceeds the 32 bit range, choose a larger unit");
+            }
+            m_fixedArc[e].head = m_head[e];
+            m_fixedArc[e].weight = static_cast<uint32_t>(units);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph::tIndex CsrGraph::getIndex(const Node& rNode) const
+{
+    auto it = m_indexByNode.find(&rNode);
+    if (it == m_indexByNode.end()) {
+        throw Graph::InvalidNodeException("node is not in the routing snapshot");
+    }
+    return it->second;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph::tIndex CsrGraph::findIndexById(const std::string& id) const
+{
+    Node* pNode = m_pGraph->findNodeById(id);
+    if (pNode == NULL) {
+        return INVALID_INDEX;
+    }
+
+    auto it = m_indexByNode.find(pNode);
+    return it != m_indexByNode.end() ? it->second : INVALID_INDEX;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph::tDistances CsrGraph::findDistancesDijkstra(tIndex src, tIndex dst) const
+{
+    typedef std::pair<double, tIndex> tHeapEntry;
+
+    tDistances result;
+    result.distance.assign(m_nodes.size(), std::numeric_limits<double>::max());
+    result.prevEdge.assign(m_nodes.size(), INVALID_INDEX);
+    std::vector<bool> settled(m_nodes.size(), false);
+
+    std::priority_queue<tHeapEntry, std::vector<tHeapEntry>, std::greater<tHeapEntry> > minHeap;
+    result.distance[src] = 0.0;
+    minHeap.push(tHeapEntry(0.0, src));
+
+    while (!minHeap.empty()) {
+        tIndex u = minHeap.top().second;
+        minHeap.pop();
+
+        if (settled[u]) {
+            continue;
+        }
+        settled[u] = true;
+
+        if (u == dst) {
+            break;
+        }
+
+        double distU = result.distance[u];
+        for (tIndex e = m_firstOut[u]; e < m_firstOut[u + 1]; e++) {
+            tIndex v = m_head[e];
+            double newDistance = distU + m_weight[e];
+            if (newDistance < result.distance[v]) {
+                result.distance[v] = newDistance;
+                result.prevEdge[v] = e;
+                minHeap.push(tHeapEntry(newDistance, v));
+            }
+        }
+    }
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph::tMetric CsrGraph::addMetric(const std::string& rName, std::vector<double> weights)
+{
+    if (weights.size() != m_head.size()) {
+        throw Graph::Exception("the metric " + rName + " needs one weight per edge");
+    }
+    for (double weight : weights) {
+        if (!(weight >= 0.0)) {
+            throw Graph::Exception("the metric " + rName + " has a negative weight");
+        }
+    }
+
+    m_metrics.push_back(std::move(weights));
+    m_metricNames.push_back(rName);
+    return static_cast<tMetric>(m_metrics.size());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph::tMetric CsrGraph::findMetric(const std::string& rName) const
+{
+    for (tMetric metric = 0; metric < m_metricNames.size(); metric++) {
+        if (m_metricNames[metric] == rName) {
+            return metric;
+        }
+    }
+    return getNumMetrics();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CsrGraph::findShortestPathDijkstra(const Node& rSrc, const Node& rDst) const
+{
+    tIndex src = getIndex(rSrc);
+    tIndex dst = getIndex(rDst);
+
+    return unpackPath(findDistancesDijkstra(src, dst), dst);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CsrGraph::findShortestPathDijkstra(const Node& rSrc, const Node& rDst, tMetric metric) const
+{
+    tIndex dst = getIndex(rDst);
+
+    DijkstraEngine engine(*this);
+    engine.run(getIndex(rSrc), dst, MetricWeight(*this, metric));
+    return engine.getPath(dst);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool CsrGraph::findShortestPathDijkstra(const Node& rSrc, const Node& rDst,
+                                        RoutingContext& rContext, Graph::tEdges& rPath) const
+{
+    tIndex dst = getIndex(rDst);
+
+    DijkstraEngine engine(*this, rContext);
+    bool found = engine.run(getIndex(rSrc), dst);
+    engine.getPath(dst, rPath);
+    return found;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CsrGraph::findShortestPathAStar(const Node& rSrc, const Node& rDst) const
+{
+    tIndex dst = getIndex(rDst);
+
+    AStarEngine engine(*this);
+    engine.run(getIndex(rSrc), dst);
+    return engine.getPath(dst);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool CsrGraph::findShortestPathAStar(const Node& rSrc, const Node& rDst,
+                                     RoutingContext& rContext, Graph::tEdges& rPath) const
+{
+    tIndex dst = getIndex(rDst);
+
+    AStarEngine engine(*this, rContext);
+    bool found = engine.run(getIndex(rSrc), dst);
+    engine.getPath(dst, rPath);
+    return found;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CsrGraph::findShortestPathBidirectional(const Node& rSrc, const Node& rDst) const
+{
+    BidirectionalDijkstraEngine engine(*this);
+    engine.run(getIndex(rSrc), getIndex(rDst));
+    return engine.getPath();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool CsrGraph::findShortestPathBidirectional(const Node& rSrc, const Node& rDst,
+                                             RoutingContext& rContext, Graph::tEdges& rPath) const
+{
+    BidirectionalDijkstraEngine engine(*this, rContext);
+    bool found = engine.run(getIndex(rSrc), getIndex(rDst));
+    engine.getPath(rPath);
+    return found;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CsrGraph::findShortestPathALT(const Node& rSrc, const Node& rDst, const LandmarkTable& rLandmarks) const
+{
+    tIndex src = getIndex(rSrc);
+    tIndex dst = getIndex(rDst);
+
+    AStarEngine engine(*this);
+    engine.run(src, dst, LandmarkHeuristic(rLandmarks, src, dst));
+    return engine.getPath(dst);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool CsrGraph::findShortestPathALT(const Node& rSrc, const Node& rDst, const LandmarkTable& rLandmarks,
+                                   RoutingContext& rContext, Graph::tEdges& rPath) const
+{
+    tIndex src = getIndex(rSrc);
+    tIndex dst = getIndex(rDst);
+
+    AStarEngine engine(*this, rContext);
+    bool found = engine.run(src, dst, LandmarkHeuristic(rLandmarks, src, dst));
+    engine.getPath(dst, rPath);
+    return found;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph::tReachable CsrGraph::findReachable(const Node& rSrc, double maxCost) const
+{
+    RoutingContext context(*this);
+    tReachable reachable;
+    findReachable(rSrc, maxCost, context, reachable);
+    return reachable;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void CsrGraph::findReachable(const Node& rSrc, double maxCost, RoutingContext& rContext, tReachable& rReachable) const
+{
+    DijkstraEngine engine(*this, rContext);
+    engine.runWithin(getIndex(rSrc), maxCost, rReachable.nodes);
+
+    rReachable.distance.clear();
+    rReachable.partialEdges.clear();
+    rReachable.partialFraction.clear();
+    for (tIndex u : rReachable.nodes) {
+        double distU = engine.getDistance(u);
+        rReachable.distance.push_back(distU);
+
+        // the edges that leave the budget are traversed up to the remaining cost
+        double remaining = maxCost - distU;
+        for (tIndex e = m_firstOut[u]; e < m_firstOut[u + 1]; e++) {
+            if (m_weight[e] > remaining && remaining > 0.0) {
+                rReachable.partialEdges.push_back(e);
+                rReachable.partialFraction.push_back(remaining / m_weight[e]);
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::vector<CsrGraph::tRoute> CsrGraph::findKShortestPaths(const Node& rSrc, const Node& rDst, size_t k,
+                                                           unsigned numThreads) const
+{
+    YenEngine engine(*this, numThreads);
+    engine.run(getIndex(rSrc), getIndex(rDst), k);
+
+    std::vector<tRoute> routes(engine.getNumPaths());
+    for (size_t i = 0; i < routes.size(); i++) {
+        routes[i].cost = engine.getCost(i);
+        routes[i].path = engine.getPath(i);
+    }
+    return routes;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::vector<CsrGraph::tRoute> CsrGraph::findAlternativeRoutes(const Node& rSrc, const Node& rDst,
+                                                              size_t maxAlternatives) const
+{
+    AlternativeRouteEngine::tOptions options;
+    options.maxAlternatives = maxAlternatives;
+    AlternativeRouteEngine engine(*this, options);
+    engine.run(getIndex(rSrc), getIndex(rDst));
+
+    std::vector<tRoute> routes(engine.getNumRoutes());
+    for (size_t i = 0; i < routes.size(); i++) {
+        routes[i].cost = engine.getCost(i);
+        routes[i].path = engine.getPath(i);
+    }
+    return routes;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::vector<double> CsrGraph::computeDistanceMatrix(const std::vector<tIndex>& rSources,
+                                                    const std::vector<tIndex>& rTargets, unsigned numThreads) const
+{
+    std::vector<double> matrix(rSources.size() * rTargets.size(), std::numeric_limits<double>::max());
+    if (matrix.empty()) {
+        return matrix;
+    }
+
+    std::vector<char> isTarget(getNumNodes(), 0);
+    size_t numTargets = 0;
+    for (tIndex target : rTargets) {
+        numTargets += isTarget[target] ? 0 : 1;
+        isTarget[target] = 1;
+    }
+
+    ThreadPool pool(numThreads);
+    std::vector<std::unique_ptr<RoutingContext> > contexts(pool.getNumThreads());
+    pool.parallelFor(rSources.size(), [&](size_t i, unsigned thread) {
+        if (!contexts[thread]) {
+            contexts[thread].reset(new RoutingContext(*this));
+        }
+        DijkstraEngine engine(*this, *contexts[thread]);
+        engine.run(rSources[i], isTarget, numTargets);
+
+        double* pRow = &matrix[i * rTargets.size()];
+        for (size_t j = 0; j < rTargets.size(); j++) {
+            pRow[j] = engine.getDistance(rTargets[j]);
+        }
+    }, 1);
+
+    return matrix;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CsrGraph::unpackPath(const tDistances& rDistances, tIndex dst) const
+{
+    Graph::tPath path;
+
+    tIndex e = rDistances.prevEdge[dst];
+    while (e != INVALID_INDEX) {
+        path.push_front(m_edges[e]);
+        e = rDistances.prevEdge[m_tail[e]];
+    }
+
+    return path;
+}
+
+
+//-------------------------------------------------------------------------------------------------
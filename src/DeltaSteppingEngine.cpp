@@ -0,0 +1,105 @@
+#include "../include/DeltaSteppingEngine.h"
+
+#include <algorithm>
+#include <limits>
+
+//-------------------------------------------------------------------------------------------------
+
+DeltaSteppingEngine::DeltaSteppingEngine(const CsrGraph& rGraph, double delta, unsigned numThreads)
+    : m_rGraph(rGraph), m_pool(numThreads), m_delta(delta),
+      m_distances(new std::atomic<double>[rGraph.getNumNodes()]), m_buckets(m_pool.getNumThreads()), m_numPhases(0)
+{
+    if (m_delta <= 0.0) {
+        double sum = 0.0;
+        for (tIndex e = 0; e < rGraph.getNumEdges(); e++) {
+            sum += rGraph.getWeight(e);
+        }
+        // the mean weight times the mean degree is the sum of the weights per node
+        m_delta = (rGraph.getNumNodes() > 0 && sum > 0.0) ? sum / rGraph.getNumNodes() : 1.0;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void DeltaSteppingEngine::run(tIndex src)
+{
+    const double infinity = std::numeric_limits<double>::max();
+    const size_t grainSize = 64;
+    m_pool.parallelFor(m_rGraph.getNumNodes(), [this, infinity](size_t v, unsigned) {
+        m_distances[v].store(infinity, std::memory_order_relaxed);
+    }, 4096);
+    for (std::vector<std::vector<tIndex> >& rBuckets : m_buckets) {
+        for (std::vector<tIndex>& rBucket : rBuckets) {
+            rBucket.clear();
+        }
+    }
+
+    m_distances[src].store(0.0, std::memory_order_relaxed);
+    m_frontier.assign(1, src);
+    m_numPhases = 0;
+    size_t bucket = 0;
+
+    while (!m_frontier.empty()) {
+        m_numPhases += 1;
+        m_pool.parallelFor(m_frontier.size(), [&](size_t i, unsigned thread) {
+            tIndex u = m_frontier[i];
+            double distU = m_distances[u].load(std::memory_order_relaxed);
+            // the node was improved into an earlier bucket and relaxed there already
+            if (static_cast<size_t>(distU / m_delta) < bucket) {
+                return;
+            }
+            std::vector<std::vector<tIndex> >& rBuckets = m_buckets[thread];
+            for (tIndex e = m_rGraph.firstOut(u); e < m_rGraph.firstOut(u + 1); e++) {
+                tIndex v = m_rGraph.getHead(e);
+                double newDistance = distU + m_rGraph.getWeight(e);
+                double oldDistance = m_distances[v].load(std::memory_order_relaxed);
+                while (newDistance < oldDistance) {
+                    if (m_distances[v].compare_exchange_weak(oldDistance, newDistance, std::memory_order_relaxed)) {
+                        size_t target = std::max(bucket, static_cast<size_t>(newDistance / m_delta));
+                        if (target >= rBuckets.size()) {
+                            rBuckets.resize(target + 1);
+                        }
+                        rBuckets[target].push_back(v);
+                        break;
+                    }
+                }
+            }
+        }, grainSize);
+
+        // the next phase works on the first non-empty bucket, which may be the current one again
+        size_t next = std::numeric_limits<size_t>::max();
+        for (const std::vector<std::vector<tIndex> >& rBuckets : m_buckets) {
+            for (size_t b = bucket; b < rBuckets.size() && b < next; b++) {
+                if (!rBuckets[b].empty()) {
+                    next = b;
+                }
+            }
+        }
+        m_frontier.clear();
+        if (next == std::numeric_limits<size_t>::max()) {
+            break;
+        }
+        for (std::vector<std::vector<tIndex> >& rBuckets : m_buckets) {
+            if (next < rBuckets.size()) {
+                m_frontier.insert(m_frontier.end(), rBuckets[next].begin(), rBuckets[next].end());
+                rBuckets[next].clear();
+            }
+        }
+        bucket = next;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void DeltaSteppingEngine::getDistances(std::vector<double>& rDistances) const
+{
+    rDistances.resize(m_rGraph.getNumNodes());
+    for (tIndex v = 0; v < m_rGraph.getNumNodes(); v++) {
+        rDistances[v] = getDistance(v);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+#include "../include/DijkstraEngine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+//-------------------------------------------------------------------------------------------------
+
+DijkstraEngine::DijkstraEngine(const CsrGraph& rGraph)
+    : m_rGraph(rGraph), m_pOwnContext(new RoutingContext(rGraph)), m_rContext(*m_pOwnContext), m_numSettled(0)
+{
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+DijkstraEngine::DijkstraEngine(const CsrGraph& rGraph, RoutingContext& rContext)
+    : m_rGraph(rGraph), m_rContext(rContext), m_numSettled(0)
+{
+    m_rContext.reserve(rGraph);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool DijkstraEngine::run(tIndex src, tIndex dst)
+{
+    return run(src, dst, MetricWeight(m_rGraph));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool DijkstraEngine::run(tIndex src, const std::vector<char>& rIsTarget, size_t numTargets)
+{
+    return search(src, std::numeric_limits<double>::max(),
+                  [&rIsTarget, &numTargets](tIndex node) { return rIsTarget[node] != 0 && --numTargets == 0; },
+                  MetricWeight(m_rGraph));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void DijkstraEngine::runWithin(tIndex src, double maxDistance, std::vector<tIndex>& rSettled)
+{
+    rSettled.clear();
+    search(src, maxDistance, [&rSettled](tIndex node) { rSettled.push_back(node); return false; }, MetricWeight(m_rGraph));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath DijkstraEngine::getPath(tIndex dst) const
+{
+    return m_rContext.getForwardSpace().getPath(m_rGraph, dst);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void DijkstraEngine::getPath(tIndex dst, Graph::tEdges& rPath) const
+{
+    m_rContext.getForwardSpace().getPath(m_rGraph, dst, rPath);
+}
+
+
+//-------------------------------------------------------------------------------------------------
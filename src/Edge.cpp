@@ -6,8 +6,11 @@
 Edge::Edge(Node& rSrc, Node& rDst) 
     : m_srcNode(rSrc), m_dstNode(rDst)  
 {  
-    rSrc.getOutEdges().push_back(this);
-    rDst.getInEdges().push_back(this);
+    // remember the positions in the adjacency of the nodes, for removal in constant time
+    m_outPos = static_cast<uint32_t>(rSrc.m_outEdges.size());
+    rSrc.m_outEdges.push_back(this);
+    m_inPos = static_cast<uint32_t>(rDst.m_inEdges.size());
+    rDst.m_inEdges.push_back(this);
 }
 
 
@@ -15,8 +18,21 @@ Edge::Edge(Node& rSrc, Node& rDst)
 
 Edge::~Edge()
 {
-    m_srcNode.getOutEdges().remove(this);
-    m_dstNode.getInEdges().remove(this);
+    // swap and pop: the last edge takes over the position of this edge.
+    // The adjacency may already have been cleared, if the whole graph is deleted.
+    Node::tEdgeVector& rOut = m_srcNode.m_outEdges;
+    if (m_outPos < rOut.size()) {
+        rOut[m_outPos] = rOut.back();
+        rOut[m_outPos]->m_outPos = m_outPos;
+        rOut.pop_back();
+    }
+
+    Node::tEdgeVector& rIn = m_dstNode.m_inEdges;
+    if (m_inPos < rIn.size()) {
+        rIn[m_inPos] = rIn.back();
+        rIn[m_inPos]->m_inPos = m_inPos;
+        rIn.pop_back();
+    }
 }
 
 
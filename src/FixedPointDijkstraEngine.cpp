@@ -0,0 +1,60 @@
+#include "../include/FixedPointDijkstraEngine.h"
+
+#include <algorithm>
+
+const FixedPointDijkstraEngine::tDistance FixedPointDijkstraEngine::INFINITE_DISTANCE;
+
+
+//-------------------------------------------------------------------------------------------------
+
+FixedPointDijkstraEngine::FixedPointDijkstraEngine(const CsrGraph& rGraph)
+    : m_rGraph(rGraph), m_round(2), m_queue(1.0), m_numSettled(0)
+{
+    if (!rGraph.hasFixedWeights()) {
+        throw Graph::Exception("the routing snapshot has no fixed point weights, freeze it with a weight unit");
+    }
+    tEntry unreached = { INFINITE_DISTANCE, CsrGraph::INVALID_INDEX, 0 };
+    m_entries.assign(rGraph.getNumNodes(), unreached);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void FixedPointDijkstraEngine::clear()
+{
+    // every search uses two stamp values (reached and settled), see SearchSpace::clear
+    m_round += 2;
+    if (m_round >= 0xFFFFFFF0u) {
+        for (tEntry& rEntry : m_entries) {
+            rEntry.stamp = 0;
+        }
+        m_round = 2;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath FixedPointDijkstraEngine::getPath(tIndex dst) const
+{
+    Graph::tPath path;
+    for (tIndex e = getPrevEdge(dst); e != CsrGraph::INVALID_INDEX; e = getPrevEdge(m_rGraph.getTail(e))) {
+        path.push_front(m_rGraph.getEdge(e));
+    }
+    return path;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void FixedPointDijkstraEngine::getPath(tIndex dst, Graph::tEdges& rPath) const
+{
+    rPath.clear();
+    for (tIndex e = getPrevEdge(dst); e != CsrGraph::INVALID_INDEX; e = getPrevEdge(m_rGraph.getTail(e))) {
+        rPath.push_back(m_rGraph.getEdge(e));
+    }
+    std::reverse(rPath.begin(), rPath.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -3,6 +3,9 @@
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include "Graph.h"
 #include "Node.h"
 #include "SimpleEdge.h"
@@ -101,7 +104,8 @@ int  GeoJSONGraphConverter::fromGeoJSON( Graph & graph, const std::string& geojs
 
                 double dist = haversineDistance(lon1, lat1, lon2, lat2);
               
-                graph.makeBiEdge<SimpleEdge>(*node1, *node2, dist);
+                // 节点均取自graph本身，跳过成员检查
+                graph.makeBiEdgeUnchecked<SimpleEdge>(*node1, *node2, dist);
             }
         }
         // 可扩展支持Point、Polygon等
@@ -109,3 +113,217 @@ int  GeoJSONGraphConverter::fromGeoJSON( Graph & graph, const std::string& geojs
     std::cout << std::endl; // 完成后换行
     return 1;
 }
+
+// 凹包的几何辅助函数, 点是平面坐标
+typedef std::pair<double, double> tPoint;
+
+static double cross(const tPoint& o, const tPoint& a, const tPoint& b) {
+    return (a.first - o.first) * (b.second - o.second) - (a.second - o.second) * (b.first - o.first);
+}
+
+static double sqDist(const tPoint& a, const tPoint& b) {
+    double dx = a.first - b.first, dy = a.second - b.second;
+    return dx * dx + dy * dy;
+}
+
+// 点p到线段ab的距离的平方
+static double sqSegDist(const tPoint& p, const tPoint& a, const tPoint& b) {
+    double dx = b.first - a.first, dy = b.second - a.second;
+    double len = dx * dx + dy * dy;
+    double t = (len > 0) ? ((p.first - a.first) * dx + (p.second - a.second) * dy) / len : 0.0;
+    t = std::max(0.0, std::min(1.0, t));
+    tPoint q(a.first + t * dx, a.second + t * dy);
+    return sqDist(p, q);
+}
+
+// 线段p1p2和p3p4是否相交, 端点离另一条线段小于1e-9(约0.1毫米)也算相交
+static bool segmentsIntersect(const tPoint& p1, const tPoint& p2, const tPoint& p3, const tPoint& p4) {
+    double d1 = cross(p3, p4, p1), d2 = cross(p3, p4, p2);
+    double d3 = cross(p1, p2, p3), d4 = cross(p1, p2, p4);
+    if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
+        return true;
+    }
+    const double TOUCH = 1e-18;
+    return sqSegDist(p1, p3, p4) < TOUCH || sqSegDist(p2, p3, p4) < TOUCH
+        || sqSegDist(p3, p1, p2) < TOUCH || sqSegDist(p4, p1, p2) < TOUCH;
+}
+
+std::vector<size_t> GeoJSONGraphConverter::concaveHull(const std::vector<tPoint>& points, double concavity) {
+    const size_t NONE = static_cast<size_t>(-1);
+
+    // 去掉重复的点
+    std::vector<size_t> order(points.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&points](size_t i, size_t j) { return points[i] < points[j]; });
+    order.erase(std::unique(order.begin(), order.end(),
+                            [&points](size_t i, size_t j) { return points[i] == points[j]; }), order.end());
+    if (order.size() < 3) {
+        return order;
+    }
+
+    // Andrew单调链算法求凸包, 逆时针
+    std::vector<size_t> hull(2 * order.size());
+    size_t h = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        while (h >= 2 && cross(points[hull[h - 2]], points[hull[h - 1]], points[order[i]]) <= 0) h--;
+        hull[h++] = order[i];
+    }
+    for (size_t i = order.size() - 1, lower = h + 1; i-- > 0;) {
+        while (h >= lower && cross(points[hull[h - 2]], points[hull[h - 1]], points[order[i]]) <= 0) h--;
+        hull[h++] = order[i];
+    }
+    hull.resize(h - 1);
+    if (hull.size() < 3) {
+        return hull;  // 所有点共线
+    }
+
+    // 凸包作为双向链表, 从长边向内挖到内部的点
+    std::vector<size_t> next(points.size(), NONE), prev(points.size(), NONE);
+    std::vector<char> onHull(points.size(), 0);
+    for (size_t i = 0; i < hull.size(); i++) {
+        next[hull[i]] = hull[(i + 1) % hull.size()];
+        prev[hull[(i + 1) % hull.size()]] = hull[i];
+        onHull[hull[i]] = 1;
+    }
+
+    // 内部的点放进均匀网格, 以便只检查一条边附近的点
+    double minX = points[order.front()].first, maxX = points[order.back()].first;
+    double minY = points[order[0]].second, maxY = minY;
+    for (size_t i : order) {
+        minY = std::min(minY, points[i].second);
+        maxY = std::max(maxY, points[i].second);
+    }
+    size_t cols = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(order.size()))));
+    size_t rows = cols;
+    double cellW = std::max(maxX - minX, 1e-12) / cols, cellH = std::max(maxY - minY, 1e-12) / rows;
+    auto cellX = [&](double x) { return std::min(cols - 1, static_cast<size_t>(std::max(0.0, (x - minX) / cellW))); };
+    auto cellY = [&](double y) { return std::min(rows - 1, static_cast<size_t>(std::max(0.0, (y - minY) / cellH))); };
+    std::vector<std::vector<size_t> > cells(cols * rows);
+    for (size_t i : order) {
+        if (!onHull[i]) {
+            cells[cellY(points[i].second) * cols + cellX(points[i].first)].push_back(i);
+        }
+    }
+
+    std::deque<size_t> queue(hull.begin(), hull.end());
+    while (!queue.empty()) {
+        size_t a = queue.front();
+        queue.pop_front();
+        size_t b = next[a];
+        const tPoint& pa = points[a];
+        const tPoint& pb = points[b];
+
+        // 只有比邻近的点长concavity倍的边才向内挖
+        double maxSqLen = sqDist(pa, pb) / (concavity * concavity);
+        double r = std::sqrt(maxSqLen);
+        size_t x0 = cellX(std::min(pa.first, pb.first) - r), x1 = cellX(std::max(pa.first, pb.first) + r);
+        size_t y0 = cellY(std::min(pa.second, pb.second) - r), y1 = cellY(std::max(pa.second, pb.second) + r);
+
+        size_t best = NONE;
+        double bestDist = std::numeric_limits<double>::max();
+        for (size_t y = y0; y <= y1; y++) {
+            for (size_t x = x0; x <= x1; x++) {
+                for (size_t p : cells[y * cols + x]) {
+                    const tPoint& pp = points[p];
+                    if (onHull[p] || std::min(sqDist(pp, pa), sqDist(pp, pb)) > maxSqLen) {
+                        continue;
+                    }
+                    // 点必须离这条边比离相邻的边更近
+                    double d = sqSegDist(pp, pa, pb);
+                    if (d < bestDist && d < sqSegDist(pp, points[prev[a]], pa) && d < sqSegDist(pp, pb, points[next[b]])) {
+                        best = p;
+                        bestDist = d;
+                    }
+                }
+            }
+        }
+        if (best == NONE) {
+            continue;
+        }
+
+        // 挖掉的三角形里和原来的边上不能有其他点, 新边也不能和凸包的边相交
+        const tPoint& pc = points[best];
+        bool valid = true;
+        for (size_t y = y0; y <= y1 && valid; y++) {
+            for (size_t x = x0; x <= x1 && valid; x++) {
+                for (size_t p : cells[y * cols + x]) {
+                    if (!onHull[p] && p != best && cross(pa, pc, points[p]) < 0 && cross(pc, pb, points[p]) < 0
+                        && cross(pb, pa, points[p]) <= 0) {
+                        valid = false;
+                        break;
+                    }
+                }
+            }
+        }
+        for (size_t c = next[b]; valid && next[c] != a; c = next[c]) {
+            if (segmentsIntersect(pa, pc, points[c], points[next[c]]) || segmentsIntersect(pc, pb, points[c], points[next[c]])) {
+                valid = false;
+            }
+        }
+        if (!valid) {
+            continue;
+        }
+
+        next[a] = best;
+        prev[best] = a;
+        next[best] = b;
+        prev[b] = best;
+        onHull[best] = 1;
+        queue.push_back(a);
+        queue.push_back(best);
+    }
+
+    std::vector<size_t> result;
+    size_t start = hull[0];
+    size_t i = start;
+    do {
+        result.push_back(i);
+        i = next[i];
+    } while (i != start);
+    return result;
+}
+
+std::string GeoJSONGraphConverter::toIsochrone(const CsrGraph& graph, const CsrGraph::tReachable& reachable, double concavity) {
+    // 顶点的经纬度: 可达节点和部分通过的边上预算用完的位置
+    std::vector<tPoint> coordinates;
+    for (CsrGraph::tIndex node : reachable.nodes) {
+        coordinates.push_back(tPoint(graph.getLon(node), graph.getLat(node)));
+    }
+    for (size_t i = 0; i < reachable.partialEdges.size(); i++) {
+        CsrGraph::tIndex tail = graph.getTail(reachable.partialEdges[i]);
+        CsrGraph::tIndex head = graph.getHead(reachable.partialEdges[i]);
+        double f = reachable.partialFraction[i];
+        coordinates.push_back(tPoint(graph.getLon(tail) + f * (graph.getLon(head) - graph.getLon(tail)),
+                                     graph.getLat(tail) + f * (graph.getLat(head) - graph.getLat(tail))));
+    }
+
+    // 凹包在局部的平面坐标里计算, 经度按纬度缩放
+    double lat0 = 0;
+    for (const tPoint& c : coordinates) {
+        lat0 += c.second / coordinates.size();
+    }
+    double scale = cos(lat0 * M_PI / 180.0);
+    std::vector<tPoint> points;
+    for (const tPoint& c : coordinates) {
+        points.push_back(tPoint(c.first * scale, c.second));
+    }
+    std::vector<size_t> hull = concaveHull(points, concavity);
+
+    json ring = json::array();
+    for (size_t i : hull) {
+        ring.push_back({coordinates[i].first, coordinates[i].second});
+    }
+    json feature;
+    feature["type"] = "Feature";
+    feature["properties"] = {{"nodes", reachable.nodes.size()}, {"partialEdges", reachable.partialEdges.size()}};
+    if (hull.size() >= 3) {
+        ring.push_back(ring[0]);
+        feature["geometry"] = {{"type", "Polygon"}, {"coordinates", json::array({ring})}};
+    } else {
+        // 少于三个不同的点时没有多边形
+        feature["geometry"] = {{"type", "MultiPoint"}, {"coordinates", ring}};
+    }
+    return feature.dump();
+}
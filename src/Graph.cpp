@@ -1,4 +1,5 @@
 #include "../include/Graph.h"
+#include "../include/CsrGraph.h"
 #include "json.hpp"
 
 #include <map>
@@ -11,9 +12,27 @@
 
 Graph::~Graph() 
 { 
+    deleteAll();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void Graph::deleteAll()
+{
+    // All nodes are deleted, so the edges don't need to unregister from them one by one.
+    for (Node* pNode : m_nodes) {
+        pNode->m_outEdges.clear();
+        pNode->m_inEdges.clear();
+    }
+
     // free all nodes and edges
-    for (Edge* pEdge : m_edges) delete pEdge;
-    for (Node* pNode : m_nodes) delete pNode;
+    for (Edge* pEdge : m_edges) m_arena.destroy(pEdge);
+    for (Node* pNode : m_nodes) m_arena.destroy(pNode);
+
+    m_edges.clear();
+    m_nodes.clear();
+    m_nodeIndex.clear();
 }
 
 
@@ -23,7 +42,7 @@ bool Graph::remove(const Edge& rEdge)
 {
     auto it = std::find(m_edges.begin(), m_edges.end(), &rEdge);
     if (it != m_edges.end()) {
-        delete *it;
+        m_arena.destroy(*it);
         m_edges.erase(it);
         return true;
     }
@@ -36,13 +55,13 @@ bool Graph::remove(const Edge& rEdge)
 
 bool Graph::remove(const Node& rNode)
 {
-    auto it = std::find(m_nodes.begin(), m_nodes.end(), &rNode);
-    if (it != m_nodes.end()) {
+    if (contains(rNode)) {
+        auto it = m_nodes.find(const_cast<Node*>(&rNode));
         // delete all edges that are connected with the given node
         auto eIt = m_edges.begin();
         while (eIt != m_edges.end()) {
             if ((*eIt)->isConnectedTo(rNode)) {
-                delete *eIt;
+                m_arena.destroy(*eIt);
                 eIt = m_edges.erase(eIt);
             }
             else {
@@ -50,7 +69,8 @@ bool Graph::remove(const Node& rNode)
             }
         }
         // delete the node
-        delete *it;
+        m_nodeIndex.erase(*it);
+        m_arena.destroy(*it);
         m_nodes.erase(it);
         return true;
     }
@@ -58,25 +78,6 @@ bool Graph::remove(const Node& rNode)
 }
 
 
-//-------------------------------------------------------------------------------------------------
-
-Node* Graph::findNodeById(const std::string& id)
-{
-    auto it = m_nodes.begin();
-    // just need to check the lower bound, since nodes are sorted by id.
-    while (it != m_nodes.end() && (*it)->getId() < id) {
-        it++;
-    }
-
-    // return the node, if found
-    if (it != m_nodes.end() && (*it)->getId() == id) {
-        return *it;
-    }
-
-    return NULL;
-}
-
-
 //-------------------------------------------------------------------------------------------------
 
 Graph::tEdges Graph::findEdges(const Node& rSrc, const Node& rDst)
@@ -161,21 +162,19 @@ Graph::tDijkstraMap Graph::findDistancesDijkstra(
     tDijkstraMap nodeTable; // 保存每个节点的最短距离和路径信息
     std::list<Node*> Q;     // 待访问节点集合（未确定最短距离的节点）
 
-    // 查找源节点指针
-    auto srcIt = std::find(m_nodes.begin(), m_nodes.end(), &rSrcNode);
-    if (srcIt == m_nodes.end()) {
+    // 检查源节点（常数时间）
+    if (!contains(rSrcNode)) {
         throw InvalidNodeException("source node is not in the graph");
     }
-    Node* pSrc = *srcIt;
+    Node* pSrc = const_cast<Node*>(&rSrcNode);
 
-    // 查找目标节点指针（如果有）
+    // 检查目标节点（如果有）
     Node* pDst = NULL;
     if (pDstNode != NULL) {
-        auto dstIt = std::find(m_nodes.begin(), m_nodes.end(), pDstNode);
-        if (dstIt == m_nodes.end()) {
+        if (!contains(*pDstNode)) {
             throw InvalidNodeException("destination node is not in the graph");
         }
-        pDst = *dstIt;
+        pDst = const_cast<Node*>(pDstNode);
     }
 
     // 初始化所有节点的距离为无穷大，前驱为NULL，并加入Q
@@ -226,84 +225,18 @@ Graph::tDijkstraMap Graph::findDistancesDijkstra(
 
 
 
-using HeapEntry = std::pair<Node*, double>;
-struct CompareDist {
-        bool operator()(const HeapEntry& lhs, const HeapEntry& rhs) const {
-            return lhs.second > rhs.second;  // 最小堆：距离小的优先
-        }
-    };
-
 /**
 * This is based on https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm 使用优先队列进行优化
+* The search itself is runDijkstraV1 in the header.
 */
 Graph::tDijkstraMap Graph::findDistancesDijkstraV1(
         const Node& rSrcNode, const Node* pDstNode, Node** pFoundDst)
 {
-
-
-    tDijkstraMap nodeTable;  // 存储最短路径信息
-    std::priority_queue<HeapEntry, std::vector<HeapEntry>, CompareDist> minHeap;
-    std::unordered_set<Node*> visited;  // 跳过已确定最短路径的节点
-    // 找到源节点指针
-    auto srcIt = std::find(m_nodes.begin(), m_nodes.end(), &rSrcNode);
-    if (srcIt == m_nodes.end()) {
-        throw InvalidNodeException("source node is not in the graph");
-    }
-    Node* pSrc = *srcIt;
-
-    // 检查目标节点（可选）
-    Node* pDst = nullptr;
-    if (pDstNode != nullptr) {
-        auto dstIt = std::find(m_nodes.begin(), m_nodes.end(), pDstNode);
-        if (dstIt == m_nodes.end()) {
-            throw InvalidNodeException("destination node is not in the graph");
-        }
-        pDst = *dstIt;
+    // a graph of SimpleEdges only inlines their weights, other graphs call the virtual getWeight
+    if (!m_edges.empty() && hasOnlyEdgesOf<SimpleEdge>()) {
+        return runDijkstraV1<SimpleEdge>(rSrcNode, pDstNode, pFoundDst);
     }
-
-    // 初始化所有节点为“未知距离”
-    for (Node* pNode : m_nodes) {
-        nodeTable[pNode] = { std::numeric_limits<double>::max(), nullptr, nullptr };
-    }
-
-    // 初始化源节点
-    nodeTable[pSrc].distance = 0.0;
-    minHeap.push({ pSrc, 0.0 });
-
-    // 主循环
-    while (!minHeap.empty()) {
-        Node* u = minHeap.top().first;
-        minHeap.pop();
-
-        if (visited.count(u)) {
-            continue;  // 已处理过
-        }
-        visited.insert(u);
-
-        // 如果到达目标节点，提前返回
-        if (u == pDst) {
-            *pFoundDst = u;
-            return nodeTable;
-        }
-
-        // 遍历所有出边
-        for (Edge* pOutEdge : u->getOutEdges()) {
-            Node* v = &pOutEdge->getDstNode();
-            double newDistance = nodeTable[u].distance + pOutEdge->getWeight();
-            tDijkstraInfo& vInfo = nodeTable[v];
-
-            if (newDistance < vInfo.distance) {
-                vInfo.distance = newDistance;
-                vInfo.prevNode = u;
-                vInfo.prevEdge = pOutEdge;
-                minHeap.push({v, newDistance});
-            }
-        }
-    }
-
-    // 未找到目标节点
-    *pFoundDst = nullptr;
-    return nodeTable;
+    return runDijkstraV1<Edge>(rSrcNode, pDstNode, pFoundDst);
 }
 
 
@@ -337,6 +270,14 @@ Graph::tPath Graph::findShortestPathDijkstra(const Node& rSrc, const Node& rDst,
 }
 
 
+//-------------------------------------------------------------------------------------------------
+
+CsrGraph Graph::freeze(double weightUnit)
+{
+    return CsrGraph(*this, weightUnit);
+}
+
+
 //-------------------------------------------------------------------------------------------------
 
 void Graph::saveAsJson(const std::string& filename) const {
@@ -367,9 +308,9 @@ void Graph::loadFromJson(const std::string& filename) {
     nlohmann::json j;
     ifs >> j;
     ifs.close();
-    // 清空原有数据（如有需要可补充）
-    m_nodes.clear();
-    m_edges.clear();
+    // 清空原有数据
+    deleteAll();
+    m_nodeIndex.reserve(j["nodes"].size());
     // 加载节点
     for (const auto& nodej : j["nodes"]) {
         std::string id = nodej["id"];
@@ -386,7 +327,8 @@ void Graph::loadFromJson(const std::string& filename) {
         Node* dstNode = findNodeById(dst);
         
         if (srcNode && dstNode) {
-            makeBiEdge<SimpleEdge>(*srcNode, *dstNode, weight);
+            // the nodes were taken from this graph, no need to check them again
+            makeBiEdgeUnchecked<SimpleEdge>(*srcNode, *dstNode, weight);
         }
     }
 }
@@ -0,0 +1,303 @@
+#include "../include/HubLabels.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "../include/ContractionHierarchy.h"
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+const char FILE_MAGIC[8] = { 'H', 'U', 'B', 'L', 'B', 'L', '0', '1' };
+
+struct tEntry
+{
+    CsrGraph::tIndex hub;
+    double distance;
+    CsrGraph::tIndex arc;
+
+    bool operator<(const tEntry& rOther) const {
+        return hub < rOther.hub || (hub == rOther.hub && distance < rOther.distance);
+    }
+};
+
+/** @return the number of arcs of the hierarchy, which identifies it in a label file. */
+CsrGraph::tIndex getNumArcs(const ContractionHierarchy& rHierarchy)
+{
+    return rHierarchy.firstUp(rHierarchy.getNumNodes()) + rHierarchy.firstDown(rHierarchy.getNumNodes());
+}
+
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+HubLabels::HubLabels() : m_pHierarchy(NULL), m_pGraph(NULL), m_numNodes(0), m_numEdges(0)
+{
+    m_first.assign(1, 0);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+HubLabels::HubLabels(const ContractionHierarchy& rHierarchy)
+    : m_pHierarchy(&rHierarchy), m_pGraph(&rHierarchy.getGraph()), m_numNodes(rHierarchy.getNumNodes()),
+      m_numEdges(rHierarchy.getGraph().getNumEdges())
+{
+    typedef ContractionHierarchy::tSearchArc tSearchArc;
+    const double infinity = std::numeric_limits<double>::max();
+
+    std::vector<tIndex> order(m_numNodes);
+    for (tIndex v = 0; v < m_numNodes; v++) {
+        order[m_numNodes - 1 - rHierarchy.getRank(v)] = v;
+    }
+
+    // the hubs of a label have a higher rank than its node, so the labels of all hubs are final
+    // when a label is pruned
+    std::vector<std::vector<tEntry> > labels(static_cast<size_t>(m_numNodes) * 2);
+    std::vector<tEntry> candidates;
+    std::vector<double> candidateDistance(m_numNodes, infinity);
+    for (tIndex v : order) {
+        for (int direction = 0; direction < 2; direction++) {
+            bool forward = direction == 0;
+            tEntry self = { v, 0.0, CsrGraph::INVALID_INDEX };
+            candidates.assign(1, self);
+
+            tIndex begin = forward ? rHierarchy.firstUp(v) : rHierarchy.firstDown(v);
+            tIndex end = forward ? rHierarchy.firstUp(v + 1) : rHierarchy.firstDown(v + 1);
+            for (tIndex i = begin; i < end; i++) {
+                const tSearchArc& rArc = forward ? rHierarchy.getUp(i) : rHierarchy.getDown(i);
+                for (const tEntry& rEntry : labels[labelIndex(rArc.node, forward)]) {
+                    tEntry candidate = { rEntry.hub, rEntry.distance + rArc.weight, rArc.arc };
+                    candidates.push_back(candidate);
+                }
+            }
+
+            // keep the shortest candidate per hub
+            std::sort(candidates.begin(), candidates.end());
+            size_t numUnique = 0;
+            for (size_t i = 0; i < candidates.size(); i++) {
+                if (numUnique == 0 || candidates[numUnique - 1].hub != candidates[i].hub) {
+                    candidates[numUnique++] = candidates[i];
+                }
+            }
+            candidates.resize(numUnique);
+            for (const tEntry& rCandidate : candidates) {
+                candidateDistance[rCandidate.hub] = rCandidate.distance;
+            }
+
+            // a candidate is not needed, if another hub leads to its hub on a path that is not longer
+            std::vector<tEntry>& rLabel = labels[labelIndex(v, forward)];
+            for (const tEntry& rCandidate : candidates) {
+                bool isCovered = false;
+                if (rCandidate.hub != v) {
+                    for (const tEntry& rEntry : labels[labelIndex(rCandidate.hub, !forward)]) {
+                        if (rEntry.hub != rCandidate.hub && candidateDistance[rEntry.hub] != infinity
+                            && candidateDistance[rEntry.hub] + rEntry.distance <= rCandidate.distance) {
+                            isCovered = true;
+                            break;
+                        }
+                    }
+                }
+                if (!isCovered) {
+                    rLabel.push_back(rCandidate);
+                }
+            }
+            for (const tEntry& rCandidate : candidates) {
+                candidateDistance[rCandidate.hub] = infinity;
+            }
+        }
+    }
+
+    m_first.assign(1, 0);
+    for (const std::vector<tEntry>& rLabel : labels) {
+        m_first.push_back(m_first.back() + rLabel.size());
+    }
+    m_hubs.reserve(m_first.back());
+    m_distances.reserve(m_first.back());
+    m_arcs.reserve(m_first.back());
+    for (std::vector<tEntry>& rLabel : labels) {
+        for (const tEntry& rEntry : rLabel) {
+            m_hubs.push_back(rEntry.hub);
+            m_distances.push_back(rEntry.distance);
+            m_arcs.push_back(rEntry.arc);
+        }
+        std::vector<tEntry>().swap(rLabel);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+double HubLabels::getDistance(const Node& rSrc, const Node& rDst) const
+{
+    if (m_pGraph == NULL) {
+        throw Graph::InvalidNodeException("the hub labels are empty");
+    }
+    return getDistance(m_pGraph->getIndex(rSrc), m_pGraph->getIndex(rDst));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t HubLabels::findEntry(tIndex node, bool forward, tIndex hub) const
+{
+    std::vector<tIndex>::const_iterator begin = m_hubs.begin() + m_first[labelIndex(node, forward)];
+    std::vector<tIndex>::const_iterator end = m_hubs.begin() + m_first[labelIndex(node, forward) + 1];
+    std::vector<tIndex>::const_iterator it = std::lower_bound(begin, end, hub);
+    return static_cast<size_t>(((it != end && *it == hub) ? it : end) - m_hubs.begin());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool HubLabels::findShortestPath(tIndex src, tIndex dst, Graph::tEdges& rPath) const
+{
+    if (m_pHierarchy == NULL) {
+        throw Graph::Exception("the hub labels were loaded without their contraction hierarchy");
+    }
+
+    rPath.clear();
+    tIndex hub;
+    if (findHub(src, dst, hub) == std::numeric_limits<double>::max()) {
+        return false;
+    }
+
+    // every entry was derived from the label of the other end of its arc, which still holds the hub
+    for (tIndex node = src; node != hub; ) {
+        tIndex arc = m_arcs[findEntry(node, true, hub)];
+        m_pHierarchy->unpackArc(arc, rPath);
+        node = m_pHierarchy->getArc(arc).head;
+    }
+
+    // the arcs from the hub to dst are found backwards
+    std::vector<tIndex> arcs;
+    for (tIndex node = dst; node != hub; ) {
+        tIndex arc = m_arcs[findEntry(node, false, hub)];
+        arcs.push_back(arc);
+        node = m_pHierarchy->getArc(arc).tail;
+    }
+    for (std::vector<tIndex>::reverse_iterator it = arcs.rbegin(); it != arcs.rend(); ++it) {
+        m_pHierarchy->unpackArc(*it, rPath);
+    }
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath HubLabels::findShortestPath(const Node& rSrc, const Node& rDst) const
+{
+    if (m_pGraph == NULL) {
+        throw Graph::InvalidNodeException("the hub labels are empty");
+    }
+    Graph::tEdges edges;
+    findShortestPath(m_pGraph->getIndex(rSrc), m_pGraph->getIndex(rDst), edges);
+    return Graph::tPath(edges.begin(), edges.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void HubLabels::saveToFile(const std::string& rFilename) const
+{
+    std::ofstream ofs(rFilename, std::ios::binary);
+    tIndex numArcs = (m_pHierarchy != NULL) ? getNumArcs(*m_pHierarchy) : 0;
+    uint64_t numEntries = m_hubs.size();
+
+    ofs.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    ofs.write(reinterpret_cast<const char*>(&m_numNodes), sizeof(m_numNodes));
+    ofs.write(reinterpret_cast<const char*>(&m_numEdges), sizeof(m_numEdges));
+    ofs.write(reinterpret_cast<const char*>(&numArcs), sizeof(numArcs));
+    ofs.write(reinterpret_cast<const char*>(&numEntries), sizeof(numEntries));
+    for (size_t first : m_first) {
+        uint64_t value = first;
+        ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    ofs.write(reinterpret_cast<const char*>(m_hubs.data()), m_hubs.size() * sizeof(tIndex));
+    ofs.write(reinterpret_cast<const char*>(m_distances.data()), m_distances.size() * sizeof(double));
+    ofs.write(reinterpret_cast<const char*>(m_arcs.data()), m_arcs.size() * sizeof(tIndex));
+
+    if (!ofs) {
+        throw Graph::Exception("cannot write the hub labels to " + rFilename);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void HubLabels::loadFromFile(const CsrGraph& rGraph, const std::string& rFilename)
+{
+    load(rGraph, CsrGraph::INVALID_INDEX, rFilename);
+    m_pHierarchy = NULL;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void HubLabels::loadFromFile(const ContractionHierarchy& rHierarchy, const std::string& rFilename)
+{
+    load(rHierarchy.getGraph(), getNumArcs(rHierarchy), rFilename);
+    m_pHierarchy = &rHierarchy;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void HubLabels::load(const CsrGraph& rGraph, tIndex numArcs, const std::string& rFilename)
+{
+    std::ifstream ifs(rFilename, std::ios::binary);
+    if (!ifs) {
+        throw Graph::Exception("cannot open the hub labels " + rFilename);
+    }
+
+    char magic[sizeof(FILE_MAGIC)];
+    tIndex numNodes = 0, numEdges = 0, fileArcs = 0;
+    uint64_t numEntries = 0;
+    ifs.read(magic, sizeof(magic));
+    ifs.read(reinterpret_cast<char*>(&numNodes), sizeof(numNodes));
+    ifs.read(reinterpret_cast<char*>(&numEdges), sizeof(numEdges));
+    ifs.read(reinterpret_cast<char*>(&fileArcs), sizeof(fileArcs));
+    ifs.read(reinterpret_cast<char*>(&numEntries), sizeof(numEntries));
+    if (!ifs || std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        throw Graph::Exception(rFilename + " is not a hub label file");
+    }
+    if (numNodes != rGraph.getNumNodes() || numEdges != rGraph.getNumEdges()) {
+        throw Graph::Exception("the hub labels " + rFilename + " were computed for a different graph");
+    }
+    if (numArcs != CsrGraph::INVALID_INDEX && numArcs != fileArcs) {
+        throw Graph::Exception("the hub labels " + rFilename + " were computed from a different hierarchy");
+    }
+
+    std::vector<size_t> first(static_cast<size_t>(numNodes) * 2 + 1);
+    for (size_t& rFirst : first) {
+        uint64_t value = 0;
+        ifs.read(reinterpret_cast<char*>(&value), sizeof(value));
+        rFirst = static_cast<size_t>(value);
+    }
+    if (!ifs || first.front() != 0 || first.back() != numEntries || !std::is_sorted(first.begin(), first.end())) {
+        throw Graph::Exception("the hub labels " + rFilename + " are damaged");
+    }
+
+    std::vector<tIndex> hubs(numEntries), arcs(numEntries);
+    std::vector<double> distances(numEntries);
+    ifs.read(reinterpret_cast<char*>(hubs.data()), hubs.size() * sizeof(tIndex));
+    ifs.read(reinterpret_cast<char*>(distances.data()), distances.size() * sizeof(double));
+    ifs.read(reinterpret_cast<char*>(arcs.data()), arcs.size() * sizeof(tIndex));
+    if (!ifs) {
+        throw Graph::Exception("the hub labels " + rFilename + " are truncated");
+    }
+
+    m_pGraph = &rGraph;
+    m_numNodes = numNodes;
+    m_numEdges = numEdges;
+    m_first.swap(first);
+    m_hubs.swap(hubs);
+    m_distances.swap(distances);
+    m_arcs.swap(arcs);
+}
+
+
+//-------------------------------------------------------------------------------------------------
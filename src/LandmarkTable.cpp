@@ -0,0 +1,377 @@
+#include "../include/LandmarkTable.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+
+const uint32_t LandmarkTable::INFINITE_DISTANCE;
+const unsigned LandmarkHeuristic::MAX_ACTIVE;
+
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+const char FILE_MAGIC[8] = { 'L', 'M', 'K', 'T', 'B', 'L', '0', '1' };
+
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+LandmarkTable::LandmarkTable() : m_numNodes(0), m_numEdges(0), m_unit(1e-3)
+{
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+LandmarkTable::LandmarkTable(const CsrGraph& rGraph, const tOptions& rOptions)
+    : m_numNodes(rGraph.getNumNodes()), m_numEdges(rGraph.getNumEdges()), m_unit(rOptions.unit)
+{
+    if (m_numNodes == 0) {
+        return;
+    }
+
+    RoutingContext context(rGraph);
+    unsigned numLandmarks = std::min<unsigned>(rOptions.numLandmarks, m_numNodes);
+    tColumns forward, backward;
+
+    // the root of the first search: the node of a fixed pseudo random sequence, so that the
+    // landmarks do not depend on anything but the graph
+    uint32_t random = 12345;
+    random = random * 1103515245u + 12345u;
+    tIndex root = random % m_numNodes;
+
+    // the first landmark is the node farthest from root
+    forward.push_back(std::vector<uint32_t>());
+    computeColumn(rGraph, root, true, context, forward.back());
+    tIndex landmark = chooseFarthest(forward);
+    forward.clear();
+
+    while (true) {
+        m_landmarks.push_back(landmark);
+        forward.push_back(std::vector<uint32_t>());
+        computeColumn(rGraph, landmark, true, context, forward.back());
+        backward.push_back(std::vector<uint32_t>());
+        computeColumn(rGraph, landmark, false, context, backward.back());
+
+        if (m_landmarks.size() >= numLandmarks) {
+            break;
+        }
+
+        if (rOptions.strategy == STRATEGY_FARTHEST) {
+            landmark = chooseFarthest(forward);
+        } else {
+            random = random * 1103515245u + 12345u;
+            landmark = chooseAvoid(rGraph, random % m_numNodes, forward, backward, context);
+        }
+    }
+
+    // node major, so that an estimate reads one block of memory
+    size_t width = 2 * m_landmarks.size();
+    m_distances.resize(width * m_numNodes);
+    for (tIndex v = 0; v < m_numNodes; v++) {
+        for (unsigned i = 0; i < m_landmarks.size(); i++) {
+            m_distances[v * width + i] = forward[i][v];
+            m_distances[v * width + m_landmarks.size() + i] = backward[i][v];
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void LandmarkTable::runRounded(const CsrGraph& rGraph, tIndex root, bool forward, RoutingContext& rContext,
+                               std::vector<tIndex>* pOrder) const
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = rContext.getForwardSpace();
+    RoutingContext::tHeap& rHeap = rContext.getForwardHeap();
+    rSpace.clear();
+    rHeap.clear();
+    if (pOrder != NULL) {
+        pOrder->clear();
+    }
+
+    // the distances are whole numbers of units, which doubles represent exactly
+    rSpace.update(root, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(0.0, root));
+
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tIndex u = rHeap.back().second;
+        rHeap.pop_back();
+
+        if (rSpace.isSettled(u)) {
+            continue;
+        }
+        rSpace.settle(u);
+        if (pOrder != NULL) {
+            pOrder->push_back(u);
+        }
+
+        double distU = rSpace.getDistance(u);
+        tIndex begin = forward ? rGraph.firstOut(u) : rGraph.firstIn(u);
+        tIndex end = forward ? rGraph.firstOut(u + 1) : rGraph.firstIn(u + 1);
+        for (tIndex i = begin; i < end; i++) {
+            tIndex e = forward ? i : rGraph.getInEdge(i);
+            tIndex v = forward ? rGraph.getHead(e) : rGraph.getTail(e);
+
+            // rounding down keeps unit * (d(L, v) - d(L, u)) <= w(u, v), i.e. the bounds consistent
+            double units = std::floor(rGraph.getWeight(e) / m_unit);
+            if (units * m_unit > rGraph.getWeight(e)) {
+                units -= 1.0;
+            }
+
+            double newDistance = distU + std::max(units, 0.0);
+            if (newDistance < rSpace.getDistance(v)) {
+                rSpace.update(v, newDistance, e);
+                rHeap.push_back(tHeapEntry(newDistance, v));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void LandmarkTable::computeColumn(const CsrGraph& rGraph, tIndex landmark, bool forward, RoutingContext& rContext,
+                                  std::vector<uint32_t>& rColumn) const
+{
+    runRounded(rGraph, landmark, forward, rContext, NULL);
+
+    const SearchSpace& rSpace = rContext.getForwardSpace();
+    rColumn.assign(m_numNodes, INFINITE_DISTANCE);
+    for (tIndex v = 0; v < m_numNodes; v++) {
+        if (!rSpace.isReached(v)) {
+            continue;
+        }
+        double distance = rSpace.getDistance(v);
+        if (distance >= INFINITE_DISTANCE) {
+            throw Graph::Exception("landmark distance exceeds the 32 bit range, choose a larger unit");
+        }
+        rColumn[v] = static_cast<uint32_t>(distance);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+LandmarkTable::tIndex LandmarkTable::chooseFarthest(const tColumns& rForward) const
+{
+    // the distance to the nearest landmark, nodes that no landmark reaches are preferred
+    tIndex best = 0;
+    uint32_t bestDistance = 0;
+    for (tIndex v = 0; v < m_numNodes; v++) {
+        uint32_t nearest = INFINITE_DISTANCE;
+        for (const std::vector<uint32_t>& rColumn : rForward) {
+            nearest = std::min(nearest, rColumn[v]);
+        }
+        if (nearest > bestDistance && std::find(m_landmarks.begin(), m_landmarks.end(), v) == m_landmarks.end()) {
+            best = v;
+            bestDistance = nearest;
+        }
+    }
+    return best;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+LandmarkTable::tIndex LandmarkTable::chooseAvoid(const CsrGraph& rGraph, tIndex root, const tColumns& rForward,
+                                                 const tColumns& rBackward, RoutingContext& rContext) const
+{
+    std::vector<tIndex> order;
+    runRounded(rGraph, root, true, rContext, &order);
+    const SearchSpace& rSpace = rContext.getForwardSpace();
+
+    // the weight of a node is the gap between its distance from root and the best bound, the
+    // size of a subtree is the sum of its weights or -1, if it holds a landmark
+    std::vector<double> size(m_numNodes, 0.0);
+    for (size_t k = order.size(); k-- > 0;) {
+        tIndex v = order[k];
+
+        int64_t bound = 0;
+        for (unsigned i = 0; i < rForward.size(); i++) {
+            if (rForward[i][v] != INFINITE_DISTANCE && rForward[i][root] != INFINITE_DISTANCE) {
+                bound = std::max(bound, static_cast<int64_t>(rForward[i][v]) - rForward[i][root]);
+            }
+            if (rBackward[i][v] != INFINITE_DISTANCE && rBackward[i][root] != INFINITE_DISTANCE) {
+                bound = std::max(bound, static_cast<int64_t>(rBackward[i][root]) - rBackward[i][v]);
+            }
+        }
+        if (std::find(m_landmarks.begin(), m_landmarks.end(), v) != m_landmarks.end()) {
+            size[v] = -1.0;
+        } else if (size[v] >= 0.0) {
+            size[v] += rSpace.getDistance(v) - static_cast<double>(bound);
+        }
+
+        tIndex prevEdge = rSpace.getPrevEdge(v);
+        if (prevEdge != CsrGraph::INVALID_INDEX) {
+            tIndex parent = rGraph.getTail(prevEdge);
+            if (size[v] < 0.0 || size[parent] < 0.0) {
+                size[parent] = -1.0;
+            } else {
+                size[parent] += size[v];
+            }
+        }
+    }
+
+    // descend from the root to the child with the largest subtree, until a leaf is reached
+    tIndex u = root;
+    while (true) {
+        tIndex next = CsrGraph::INVALID_INDEX;
+        double nextSize = 0.0;
+        for (tIndex e = rGraph.firstOut(u); e < rGraph.firstOut(u + 1); e++) {
+            tIndex v = rGraph.getHead(e);
+            if (rSpace.getPrevEdge(v) == e && size[v] > nextSize) {
+                next = v;
+                nextSize = size[v];
+            }
+        }
+        if (next == CsrGraph::INVALID_INDEX) {
+            break;
+        }
+        u = next;
+    }
+
+    // every subtree holds a landmark: fall back to the farthest node
+    if (std::find(m_landmarks.begin(), m_landmarks.end(), u) != m_landmarks.end()) {
+        return chooseFarthest(rForward);
+    }
+    return u;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+int64_t LandmarkTable::getLandmarkBound(tIndex src, tIndex dst, unsigned i) const
+{
+    int64_t bound = std::numeric_limits<int64_t>::min();
+    if (getForward(src, i) != INFINITE_DISTANCE && getForward(dst, i) != INFINITE_DISTANCE) {
+        bound = std::max(bound, static_cast<int64_t>(getForward(dst, i)) - getForward(src, i));
+    }
+    if (getBackward(src, i) != INFINITE_DISTANCE && getBackward(dst, i) != INFINITE_DISTANCE) {
+        bound = std::max(bound, static_cast<int64_t>(getBackward(src, i)) - getBackward(dst, i));
+    }
+    return bound;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+double LandmarkTable::getLowerBound(tIndex src, tIndex dst) const
+{
+    int64_t best = 0;
+    for (unsigned i = 0; i < getNumLandmarks(); i++) {
+        best = std::max(best, getLandmarkBound(src, dst, i));
+    }
+    return best * m_unit;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void LandmarkTable::saveToFile(const std::string& rFilename) const
+{
+    std::ofstream ofs(rFilename, std::ios::binary);
+    uint32_t numLandmarks = getNumLandmarks();
+
+    ofs.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    ofs.write(reinterpret_cast<const char*>(&m_numNodes), sizeof(m_numNodes));
+    ofs.write(reinterpret_cast<const char*>(&m_numEdges), sizeof(m_numEdges));
+    ofs.write(reinterpret_cast<const char*>(&numLandmarks), sizeof(numLandmarks));
+    ofs.write(reinterpret_cast<const char*>(&m_unit), sizeof(m_unit));
+    ofs.write(reinterpret_cast<const char*>(m_landmarks.data()), m_landmarks.size() * sizeof(tIndex));
+    ofs.write(reinterpret_cast<const char*>(m_distances.data()), m_distances.size() * sizeof(uint32_t));
+
+    if (!ofs) {
+        throw Graph::Exception("cannot write the landmark table to " + rFilename);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void LandmarkTable::loadFromFile(const CsrGraph& rGraph, const std::string& rFilename)
+{
+    std::ifstream ifs(rFilename, std::ios::binary);
+    if (!ifs) {
+        throw Graph::Exception("cannot open the landmark table " + rFilename);
+    }
+
+    char magic[sizeof(FILE_MAGIC)];
+    tIndex numNodes = 0, numEdges = 0;
+    uint32_t numLandmarks = 0;
+    double unit = 0.0;
+    ifs.read(magic, sizeof(magic));
+    ifs.read(reinterpret_cast<char*>(&numNodes), sizeof(numNodes));
+    ifs.read(reinterpret_cast<char*>(&numEdges), sizeof(numEdges));
+    ifs.read(reinterpret_cast<char*>(&numLandmarks), sizeof(numLandmarks));
+    ifs.read(reinterpret_cast<char*>(&unit), sizeof(unit));
+    if (!ifs || std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        throw Graph::Exception(rFilename + " is not a landmark table");
+    }
+    if (numNodes != rGraph.getNumNodes() || numEdges != rGraph.getNumEdges()) {
+        throw Graph::Exception("the landmark table " + rFilename + " was computed for a different graph");
+    }
+
+    std::vector<tIndex> landmarks(numLandmarks);
+    std::vector<uint32_t> distances(static_cast<size_t>(numNodes) * 2 * numLandmarks);
+    ifs.read(reinterpret_cast<char*>(landmarks.data()), landmarks.size() * sizeof(tIndex));
+    ifs.read(reinterpret_cast<char*>(distances.data()), distances.size() * sizeof(uint32_t));
+    if (!ifs) {
+        throw Graph::Exception("the landmark table " + rFilename + " is truncated");
+    }
+
+    m_landmarks.swap(landmarks);
+    m_distances.swap(distances);
+    m_numNodes = numNodes;
+    m_numEdges = numEdges;
+    m_unit = unit;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+LandmarkHeuristic::LandmarkHeuristic(const LandmarkTable& rTable, CsrGraph::tIndex src, CsrGraph::tIndex dst,
+                                     unsigned numActive)
+    : m_rTable(rTable), m_unit(rTable.getUnit()), m_numActive(0)
+{
+    numActive = std::min(std::min(numActive, MAX_ACTIVE), rTable.getNumLandmarks());
+
+    // keep the landmarks with the best bounds from src to dst, sorted by insertion
+    int64_t bounds[MAX_ACTIVE];
+    for (unsigned i = 0; i < rTable.getNumLandmarks(); i++) {
+        int64_t bound = rTable.getLandmarkBound(src, dst, i);
+        unsigned k = m_numActive;
+        if (k == numActive) {
+            if (numActive == 0 || bound <= bounds[k - 1]) {
+                continue;
+            }
+            k -= 1;
+        } else {
+            m_numActive += 1;
+        }
+        for (; k > 0 && bounds[k - 1] < bound; k--) {
+            bounds[k] = bounds[k - 1];
+            m_active[k] = m_active[k - 1];
+        }
+        bounds[k] = bound;
+        m_active[k] = i;
+    }
+
+    for (unsigned k = 0; k < m_numActive; k++) {
+        m_targetForward[k] = rTable.getForward(dst, m_active[k]);
+        m_targetBackward[k] = rTable.getBackward(dst, m_active[k]);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
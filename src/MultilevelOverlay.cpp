@@ -0,0 +1,564 @@
+#include "../include/MultilevelOverlay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+#include "../include/ThreadPool.h"
+
+//-------------------------------------------------------------------------------------------------
+
+MultilevelOverlay::MultilevelOverlay(const CsrGraph& rGraph, const tOptions& rOptions)
+    : m_rGraph(rGraph), m_pPool(new ThreadPool(rOptions.numThreads)), m_numLevels(0), m_maxCellSize(0)
+{
+    partition(rOptions.cellSizes);
+    findBoundaries();
+    customize();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+MultilevelOverlay::~MultilevelOverlay()
+{
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void MultilevelOverlay::partition(const std::vector<tIndex>& rCellSizes)
+{
+    typedef std::pair<tIndex, tIndex> tRange;
+    tIndex numNodes = m_rGraph.getNumNodes();
+
+    // a level whose cells could hold the whole graph would have a single cell without boundary
+    std::vector<tIndex> sizes;
+    for (tIndex size : rCellSizes) {
+        if (size > 0 && size < numNodes) {
+            sizes.push_back(size);
+        }
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    m_numLevels = static_cast<unsigned>(sizes.size());
+
+    // the breadth first order (ignoring the directions) breaks the ties of the coordinates, so
+    // that graphs without coordinates are still cut into connected pieces
+    std::vector<tIndex> bfsRank(numNodes, CsrGraph::INVALID_INDEX);
+    std::vector<tIndex> queue;
+    queue.reserve(numNodes);
+    for (tIndex root = 0; root < numNodes; root++) {
+        if (bfsRank[root] != CsrGraph::INVALID_INDEX) {
+            continue;
+        }
+        size_t head = queue.size();
+        bfsRank[root] = static_cast<tIndex>(queue.size());
+        queue.push_back(root);
+        while (head < queue.size()) {
+            tIndex u = queue[head++];
+            for (tIndex e = m_rGraph.firstOut(u); e < m_rGraph.firstOut(u + 1); e++) {
+                tIndex w = m_rGraph.getHead(e);
+                if (bfsRank[w] == CsrGraph::INVALID_INDEX) {
+                    bfsRank[w] = static_cast<tIndex>(queue.size());
+                    queue.push_back(w);
+                }
+            }
+            for (tIndex i = m_rGraph.firstIn(u); i < m_rGraph.firstIn(u + 1); i++) {
+                tIndex w = m_rGraph.getTail(m_rGraph.getInEdge(i));
+                if (bfsRank[w] == CsrGraph::INVALID_INDEX) {
+                    bfsRank[w] = static_cast<tIndex>(queue.size());
+                    queue.push_back(w);
+                }
+            }
+        }
+    }
+
+    // recursive bisection along the longer side of the bounding box. Every range of the
+    // recursion that fits into the cell size of a level, while its parent range does not,
+    // becomes a cell of that level, so the cells are nested.
+    m_order.resize(numNodes);
+    for (tIndex v = 0; v < numNodes; v++) {
+        m_order[v] = v;
+    }
+
+    std::vector<std::vector<tRange> > cellRanges(m_numLevels);
+    std::vector<std::pair<tRange, tIndex> > stack;     // the ranges to split and their parent size
+    stack.push_back(std::make_pair(tRange(0, numNodes), CsrGraph::INVALID_INDEX));
+    while (!stack.empty()) {
+        tIndex begin = stack.back().first.first;
+        tIndex end = stack.back().first.second;
+        tIndex parentSize = stack.back().second;
+        stack.pop_back();
+
+        tIndex size = end - begin;
+        for (unsigned l = 0; l < m_numLevels; l++) {
+            if (size <= sizes[l] && parentSize > sizes[l]) {
+                cellRanges[l].push_back(tRange(begin, end));
+            }
+        }
+        if (m_numLevels == 0 || size <= sizes[0]) {
+            continue;
+        }
+
+        double minLon = m_rGraph.getLon(m_order[begin]), maxLon = minLon;
+        double minLat = m_rGraph.getLat(m_order[begin]), maxLat = minLat;
+        for (tIndex p = begin; p < end; p++) {
+            minLon = std::min(minLon, m_rGraph.getLon(m_order[p]));
+            maxLon = std::max(maxLon, m_rGraph.getLon(m_order[p]));
+            minLat = std::min(minLat, m_rGraph.getLat(m_order[p]));
+            maxLat = std::max(maxLat, m_rGraph.getLat(m_order[p]));
+        }
+        const double pi = 3.14159265358979323846;
+        bool byLon = (maxLon - minLon) * std::cos((minLat + maxLat) / 2.0 * pi / 180.0) > maxLat - minLat;
+
+        const CsrGraph& rGraph = m_rGraph;
+        tIndex mid = begin + size / 2;
+        std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end,
+            [&](tIndex a, tIndex b) {
+                double keyA = byLon ? rGraph.getLon(a) : rGraph.getLat(a);
+                double keyB = byLon ? rGraph.getLon(b) : rGraph.getLat(b);
+                return keyA < keyB || (keyA == keyB && bfsRank[a] < bfsRank[b]);
+            });
+
+        // the left half is split first, so the cells of every level are ordered by their range
+        stack.push_back(std::make_pair(tRange(mid, end), size));
+        stack.push_back(std::make_pair(tRange(begin, mid), size));
+    }
+
+    m_position.resize(numNodes);
+    for (tIndex p = 0; p < numNodes; p++) {
+        m_position[m_order[p]] = p;
+    }
+
+    m_firstCell.assign(1, 0);
+    m_nodeLevels.resize(static_cast<size_t>(numNodes) * m_numLevels);
+    for (unsigned l = 0; l < m_numLevels; l++) {
+        for (const tRange& rRange : cellRanges[l]) {
+            tCell cell = { rRange.first, rRange.second, 0, 0, 0, 0, 0 };
+            for (tIndex p = cell.begin; p < cell.end; p++) {
+                tNodeLevel& rLevel = m_nodeLevels[static_cast<size_t>(m_order[p]) * m_numLevels + l];
+                rLevel.cell = static_cast<tIndex>(m_cells.size());
+                rLevel.entry = CsrGraph::INVALID_INDEX;
+                rLevel.exit = CsrGraph::INVALID_INDEX;
+            }
+            m_maxCellSize = std::max(m_maxCellSize, cell.end - cell.begin);
+            m_cells.push_back(cell);
+        }
+        m_firstCell.push_back(static_cast<tIndex>(m_cells.size()));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void MultilevelOverlay::findBoundaries()
+{
+    tIndex numNodes = m_rGraph.getNumNodes();
+    size_t numCliqueArcs = 0;
+
+    m_firstEntry.assign(1, 0);
+    std::vector<char> isEntry(numNodes), isExit(numNodes);
+    for (unsigned level = 1; level <= m_numLevels; level++) {
+        std::fill(isEntry.begin(), isEntry.end(), 0);
+        std::fill(isExit.begin(), isExit.end(), 0);
+        for (tIndex e = 0; e < m_rGraph.getNumEdges(); e++) {
+            tIndex tail = m_rGraph.getTail(e);
+            tIndex head = m_rGraph.getHead(e);
+            if (getNodeLevel(tail, level).cell != getNodeLevel(head, level).cell) {
+                isExit[tail] = 1;
+                isEntry[head] = 1;
+            }
+        }
+
+        for (tIndex c = m_firstCell[level - 1]; c < m_firstCell[level]; c++) {
+            tCell& rCell = m_cells[c];
+            rCell.firstEntry = static_cast<tIndex>(m_entries.size());
+            rCell.firstExit = static_cast<tIndex>(m_exits.size());
+            for (tIndex p = rCell.begin; p < rCell.end; p++) {
+                tIndex v = m_order[p];
+                tNodeLevel& rLevel = m_nodeLevels[static_cast<size_t>(v) * m_numLevels + level - 1];
+                if (isEntry[v]) {
+                    rLevel.entry = static_cast<tIndex>(m_entries.size()) - rCell.firstEntry;
+                    m_entries.push_back(v);
+                }
+                if (isExit[v]) {
+                    rLevel.exit = static_cast<tIndex>(m_exits.size()) - rCell.firstExit;
+                    m_exits.push_back(v);
+                }
+            }
+            rCell.numEntries = static_cast<tIndex>(m_entries.size()) - rCell.firstEntry;
+            rCell.numExits = static_cast<tIndex>(m_exits.size()) - rCell.firstExit;
+            rCell.firstClique = numCliqueArcs;
+            numCliqueArcs += static_cast<size_t>(rCell.numEntries) * rCell.numExits;
+        }
+        m_firstEntry.push_back(static_cast<tIndex>(m_entries.size()));
+    }
+
+    if (m_rGraph.getNumEdges() + numCliqueArcs >= CsrGraph::INVALID_INDEX) {
+        throw Graph::Exception("The overlay has too many clique arcs, choose larger cells.");
+    }
+    m_cliques.assign(numCliqueArcs, infinity());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void MultilevelOverlay::customize()
+{
+    m_weights.resize(m_rGraph.getNumEdges());
+    for (tIndex e = 0; e < m_rGraph.getNumEdges(); e++) {
+        m_weights[e] = m_rGraph.getEdge(e)->getWeight();
+    }
+
+    std::vector<tWorkspace> workspaces(m_pPool->getNumThreads());
+    for (tWorkspace& rWork : workspaces) {
+        rWork.space.resize(m_maxCellSize);
+    }
+
+    // the searches of a level only read the cliques of the level below
+    for (unsigned level = 1; level <= m_numLevels; level++) {
+        tIndex firstEntry = m_firstEntry[level - 1];
+        m_pPool->parallelFor(m_firstEntry[level] - firstEntry, [&](size_t i, unsigned thread) {
+            computeCliqueRow(level, firstEntry + static_cast<tIndex>(i), workspaces[thread]);
+        }, 4);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void MultilevelOverlay::computeCliqueRow(unsigned level, tIndex entry, tWorkspace& rWork)
+{
+    tIndex src = m_entries[entry];
+    const tNodeLevel& rLevel = getNodeLevel(src, level);
+    const tCell& rCell = m_cells[rLevel.cell];
+
+    searchCell(level, src, CsrGraph::INVALID_INDEX, rWork);
+
+    size_t row = rCell.firstClique + static_cast<size_t>(rLevel.entry) * rCell.numExits;
+    for (tIndex j = 0; j < rCell.numExits; j++) {
+        tIndex exit = m_exits[rCell.firstExit + j];
+        m_cliques[row + j] = rWork.space.getDistance(m_position[exit] - rCell.begin);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void MultilevelOverlay::searchCell(unsigned level, tIndex src, tIndex dst, tWorkspace& rWork) const
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    tIndex cell = getNodeLevel(src, level).cell;
+    const tCell& rCell = m_cells[cell];
+    SearchSpace& rSpace = rWork.space;
+    RoutingContext::tHeap& rHeap = rWork.heap;
+    rSpace.clear();
+    rHeap.clear();
+
+    tIndex numTargets = (dst == CsrGraph::INVALID_INDEX) ? rCell.numExits : 1;
+    rSpace.update(m_position[src] - rCell.begin, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(0.0, src));
+
+    while (!rHeap.empty() && numTargets > 0) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tIndex u = rHeap.back().second;
+        rHeap.pop_back();
+
+        tIndex localU = m_position[u] - rCell.begin;
+        if (rSpace.isSettled(localU)) {
+            continue;
+        }
+        rSpace.settle(localU);
+        bool isTarget = (dst == CsrGraph::INVALID_INDEX) ? getNodeLevel(u, level).exit != CsrGraph::INVALID_INDEX : u == dst;
+        numTargets -= isTarget ? 1 : 0;
+
+        double distU = rSpace.getDistance(localU);
+        forEachOutArc(u, level - 1, [&](tIndex head, double weight, tIndex arc) {
+            if (getNodeLevel(head, level).cell != cell) {
+                return;
+            }
+            tIndex localHead = m_position[head] - rCell.begin;
+            double newDistance = distU + weight;
+            if (newDistance < rSpace.getDistance(localHead)) {
+                rSpace.update(localHead, newDistance, arc);
+                rHeap.push_back(tHeapEntry(newDistance, head));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        });
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+const MultilevelOverlay::tCell& MultilevelOverlay::findCliqueArc(tIndex arc, tIndex& rEntry, tIndex& rExit) const
+{
+    // cells without a clique share their firstClique with the next cell, so the last cell that
+    // starts at or before the arc holds it
+    size_t index = arc - m_rGraph.getNumEdges();
+    std::vector<tCell>::const_iterator it = std::upper_bound(m_cells.begin(), m_cells.end(), index,
+        [](size_t value, const tCell& rCell) { return value < rCell.firstClique; });
+    const tCell& rCell = *(it - 1);
+    rEntry = static_cast<tIndex>((index - rCell.firstClique) / rCell.numExits);
+    rExit = static_cast<tIndex>((index - rCell.firstClique) % rCell.numExits);
+    return rCell;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+MultilevelOverlay::tIndex MultilevelOverlay::getTail(tIndex arc) const
+{
+    if (arc < m_rGraph.getNumEdges()) {
+        return m_rGraph.getTail(arc);
+    }
+    tIndex entry, exit;
+    const tCell& rCell = findCliqueArc(arc, entry, exit);
+    return m_entries[rCell.firstEntry + entry];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+MultilevelOverlay::tIndex MultilevelOverlay::getHead(tIndex arc) const
+{
+    if (arc < m_rGraph.getNumEdges()) {
+        return m_rGraph.getHead(arc);
+    }
+    tIndex entry, exit;
+    const tCell& rCell = findCliqueArc(arc, entry, exit);
+    return m_exits[rCell.firstExit + exit];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+unsigned MultilevelOverlay::getQueryLevel(tIndex node, tIndex src, tIndex dst) const
+{
+    // the cells are nested: a node that shares no cell with src and dst on a level shares none
+    // on the levels below either
+    for (unsigned level = m_numLevels; level > 0; level--) {
+        tIndex cell = getNodeLevel(node, level).cell;
+        if (cell != getNodeLevel(src, level).cell && cell != getNodeLevel(dst, level).cell) {
+            return level;
+        }
+    }
+    return 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void MultilevelOverlay::unpackArc(tIndex arc, tWorkspace& rWork, Graph::tEdges& rPath) const
+{
+    if (arc < m_rGraph.getNumEdges()) {
+        rPath.push_back(m_rGraph.getEdge(arc));
+        return;
+    }
+
+    // a clique arc is the shortest path in its cell over the arcs of the level below
+    tIndex entry, exit;
+    const tCell& rCell = findCliqueArc(arc, entry, exit);
+    unsigned level = static_cast<unsigned>(std::upper_bound(m_firstCell.begin(), m_firstCell.end(),
+                                                            static_cast<tIndex>(&rCell - &m_cells[0])) - m_firstCell.begin());
+    tIndex src = m_entries[rCell.firstEntry + entry];
+    tIndex dst = m_exits[rCell.firstExit + exit];
+    searchCell(level, src, dst, rWork);
+
+    // the nested unpacking reuses the workspace, so the arcs of this level are kept in rWork.arcs
+    size_t begin = rWork.arcs.size();
+    for (tIndex node = dst; node != src; ) {
+        tIndex prevArc = rWork.space.getPrevEdge(m_position[node] - rCell.begin);
+        rWork.arcs.push_back(prevArc);
+        node = getTail(prevArc);
+    }
+    std::reverse(rWork.arcs.begin() + begin, rWork.arcs.end());
+
+    size_t end = rWork.arcs.size();
+    for (size_t i = begin; i < end; i++) {
+        unpackArc(rWork.arcs[i], rWork, rPath);
+    }
+    rWork.arcs.resize(begin);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath MultilevelOverlay::findShortestPath(const Node& rSrc, const Node& rDst) const
+{
+    CRPQueryEngine engine(*this);
+    engine.run(m_rGraph.getIndex(rSrc), m_rGraph.getIndex(rDst));
+    return engine.getPath();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool MultilevelOverlay::findShortestPath(const Node& rSrc, const Node& rDst,
+                                         RoutingContext& rContext, Graph::tEdges& rPath) const
+{
+    CRPQueryEngine engine(*this, rContext);
+    bool found = engine.run(m_rGraph.getIndex(rSrc), m_rGraph.getIndex(rDst));
+    engine.getPath(rPath);
+    return found;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CRPQueryEngine::CRPQueryEngine(const MultilevelOverlay& rOverlay)
+    : m_rOverlay(rOverlay), m_pOwnContext(new RoutingContext()), m_rContext(*m_pOwnContext),
+      m_src(CsrGraph::INVALID_INDEX), m_dst(CsrGraph::INVALID_INDEX),
+      m_distance(std::numeric_limits<double>::max()), m_meetingNode(CsrGraph::INVALID_INDEX), m_numSettled(0)
+{
+    m_rContext.reserve(rOverlay.getGraph(), true);
+    m_workspace.space.resize(rOverlay.getMaxCellSize());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+CRPQueryEngine::CRPQueryEngine(const MultilevelOverlay& rOverlay, RoutingContext& rContext)
+    : m_rOverlay(rOverlay), m_rContext(rContext),
+      m_src(CsrGraph::INVALID_INDEX), m_dst(CsrGraph::INVALID_INDEX),
+      m_distance(std::numeric_limits<double>::max()), m_meetingNode(CsrGraph::INVALID_INDEX), m_numSettled(0)
+{
+    m_rContext.reserve(rOverlay.getGraph(), true);
+    m_workspace.space.resize(rOverlay.getMaxCellSize());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool CRPQueryEngine::run(tIndex src, tIndex dst)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    const double infinity = std::numeric_limits<double>::max();
+
+    RoutingContext::tHeap& rForwardHeap = m_rContext.getForwardHeap();
+    RoutingContext::tHeap& rBackwardHeap = m_rContext.getBackwardHeap();
+    m_rContext.getForwardSpace().clear();
+    m_rContext.getBackwardSpace().clear();
+    rForwardHeap.clear();
+    rBackwardHeap.clear();
+
+    m_src = src;
+    m_dst = dst;
+    m_distance = infinity;
+    m_meetingNode = CsrGraph::INVALID_INDEX;
+    m_numSettled = 0;
+
+    m_rContext.getForwardSpace().update(src, 0.0, CsrGraph::INVALID_INDEX);
+    rForwardHeap.push_back(tHeapEntry(0.0, src));
+    m_rContext.getBackwardSpace().update(dst, 0.0, CsrGraph::INVALID_INDEX);
+    rBackwardHeap.push_back(tHeapEntry(0.0, dst));
+
+    if (src == dst) {
+        m_distance = 0.0;
+        m_meetingNode = src;
+        return true;
+    }
+
+    while (true) {
+        double forwardMin = rForwardHeap.empty() ? infinity : rForwardHeap.front().first;
+        double backwardMin = rBackwardHeap.empty() ? infinity : rBackwardHeap.front().first;
+        if (forwardMin == infinity || backwardMin == infinity || forwardMin + backwardMin >= m_distance) {
+            break;
+        }
+
+        step(forwardMin <= backwardMin);
+    }
+
+    return m_meetingNode != CsrGraph::INVALID_INDEX;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void CRPQueryEngine::step(bool forward)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = forward ? m_rContext.getForwardSpace() : m_rContext.getBackwardSpace();
+    const SearchSpace& rOtherSpace = forward ? m_rContext.getBackwardSpace() : m_rContext.getForwardSpace();
+    RoutingContext::tHeap& rHeap = forward ? m_rContext.getForwardHeap() : m_rContext.getBackwardHeap();
+
+    std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+    tIndex u = rHeap.back().second;
+    rHeap.pop_back();
+
+    // skip outdated heap entries
+    if (rSpace.isSettled(u)) {
+        return;
+    }
+    rSpace.settle(u);
+    m_numSettled += 1;
+
+    double distU = rSpace.getDistance(u);
+    auto relaxArc = [&](tIndex node, double weight, tIndex arc) {
+        double newDistance = distU + weight;
+        if (newDistance < rSpace.getDistance(node)) {
+            rSpace.update(node, newDistance, arc);
+            rHeap.push_back(tHeapEntry(newDistance, node));
+            std::push_heap(rHeap.begin(), rHeap.end(), compare);
+
+            if (rOtherSpace.isReached(node) && newDistance + rOtherSpace.getDistance(node) < m_distance) {
+                m_distance = newDistance + rOtherSpace.getDistance(node);
+                m_meetingNode = node;
+            }
+        }
+    };
+
+    unsigned level = m_rOverlay.getQueryLevel(u, m_src, m_dst);
+    if (forward) {
+        m_rOverlay.forEachOutArc(u, level, relaxArc);
+    } else {
+        m_rOverlay.forEachInArc(u, level, relaxArc);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath CRPQueryEngine::getPath()
+{
+    Graph::tEdges edges;
+    getPath(edges);
+    return Graph::tPath(edges.begin(), edges.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void CRPQueryEngine::getPath(Graph::tEdges& rPath)
+{
+    rPath.clear();
+    if (m_meetingNode == CsrGraph::INVALID_INDEX) {
+        return;
+    }
+
+    // the arcs of the overlay from the source over the meeting node to the target
+    const SearchSpace& rForwardSpace = m_rContext.getForwardSpace();
+    const SearchSpace& rBackwardSpace = m_rContext.getBackwardSpace();
+    m_arcs.clear();
+    for (tIndex arc = rForwardSpace.getPrevEdge(m_meetingNode); arc != CsrGraph::INVALID_INDEX;
+         arc = rForwardSpace.getPrevEdge(m_rOverlay.getTail(arc))) {
+        m_arcs.push_back(arc);
+    }
+    std::reverse(m_arcs.begin(), m_arcs.end());
+    for (tIndex arc = rBackwardSpace.getPrevEdge(m_meetingNode); arc != CsrGraph::INVALID_INDEX;
+         arc = rBackwardSpace.getPrevEdge(m_rOverlay.getHead(arc))) {
+        m_arcs.push_back(arc);
+    }
+
+    for (tIndex arc : m_arcs) {
+        m_rOverlay.unpackArc(arc, m_workspace, rPath);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
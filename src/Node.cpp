@@ -38,21 +38,33 @@ Node::Node(std::string id, double lon, double lat) : m_id(id), m_lon(lon), m_lat
 
 //-------------------------------------------------------------------------------------------------
 
-std::list<Node*> Node::getNeighbours(Direction direction)
+Node::NeighbourRange Node::getNeighbours(Direction direction) const
 {
-    std::list<Node*> ret;
-
-    if (direction == DIR_OUT || direction == DIR_BOTH) {
-        for (Edge* pEdge : m_outEdges)
-            ret.push_back(&pEdge->getDstNode());
+    // an empty range of out-edges or in-edges is expressed by begin == end
+    Edge* const* pOut = m_outEdges.begin();
+    Edge* const* pOutEnd = m_outEdges.end();
+    Edge* const* pIn = m_inEdges.begin();
+    Edge* const* pInEnd = m_inEdges.end();
+
+    if (direction == DIR_IN) {
+        pOutEnd = pOut;
     }
-
-    if (direction == DIR_IN || direction == DIR_BOTH) {
-        for (Edge* pEdge : m_inEdges)
-            ret.push_back(&pEdge->getSrcNode());
+    else if (direction == DIR_OUT) {
+        pInEnd = pIn;
     }
 
-    return ret;
+    return NeighbourRange(NeighbourIterator(pOut, pOutEnd, pIn), NeighbourIterator(pOutEnd, pOutEnd, pInEnd));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Node* Node::NeighbourIterator::operator*() const
+{
+    if (m_pOut != m_pOutEnd) {
+        return &(*m_pOut)->getDstNode();
+    }
+    return &(*m_pIn)->getSrcNode();
 }
 
 
@@ -0,0 +1,154 @@
+#include "../include/NodeIndex.h"
+
+#include <cstdint>
+
+//-------------------------------------------------------------------------------------------------
+
+size_t NodeIndex::hash(const char* id, size_t length)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        h ^= static_cast<unsigned char>(id[i]);
+        h *= 1099511628211ull;
+    }
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t NodeIndex::findSlot(const char* id, size_t length, size_t hash) const
+{
+    size_t mask = m_slots.size() - 1;
+    size_t i = hash & mask;
+
+    while (m_slots[i].pNode != NULL) {
+        const tSlot& rSlot = m_slots[i];
+        // compare the hashes first, in order to touch the node only for real candidates
+        if (rSlot.hash == hash) {
+            const std::string& rId = rSlot.pNode->getId();
+            if (rId.size() == length && std::memcmp(rId.data(), id, length) == 0) {
+                return i;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+
+    return i;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Node* NodeIndex::find(const char* id, size_t length) const
+{
+    if (m_size == 0) {
+        return NULL;
+    }
+
+    return m_slots[findSlot(id, length, hash(id, length))].pNode;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool NodeIndex::insert(Node* pNode)
+{
+    // keep the load factor below 1/2
+    if (2 * (m_size + 1) > m_slots.size()) {
+        rehash(m_slots.empty() ? 16 : 2 * m_slots.size());
+    }
+
+    const std::string& rId = pNode->getId();
+    size_t h = hash(rId.data(), rId.size());
+    size_t i = findSlot(rId.data(), rId.size(), h);
+    if (m_slots[i].pNode != NULL) {
+        return false;
+    }
+
+    m_slots[i].hash = h;
+    m_slots[i].pNode = pNode;
+    m_size += 1;
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool NodeIndex::erase(const Node* pNode)
+{
+    if (m_size == 0) {
+        return false;
+    }
+
+    const std::string& rId = pNode->getId();
+    size_t i = findSlot(rId.data(), rId.size(), hash(rId.data(), rId.size()));
+    if (m_slots[i].pNode != pNode) {
+        return false;
+    }
+
+    // backward shift deletion: move the following entries of the cluster into the gap,
+    // if the gap is not in front of their home slot. So no tombstones are needed.
+    size_t mask = m_slots.size() - 1;
+    size_t gap = i;
+    size_t j = (i + 1) & mask;
+    while (m_slots[j].pNode != NULL) {
+        size_t home = m_slots[j].hash & mask;
+        if (((j - home) & mask) >= ((j - gap) & mask)) {
+            m_slots[gap] = m_slots[j];
+            gap = j;
+        }
+        j = (j + 1) & mask;
+    }
+    m_slots[gap].pNode = NULL;
+    m_size -= 1;
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void NodeIndex::reserve(size_t numNodes)
+{
+    size_t numSlots = 16;
+    while (numSlots < 2 * numNodes) {
+        numSlots *= 2;
+    }
+
+    if (numSlots > m_slots.size()) {
+        rehash(numSlots);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void NodeIndex::clear()
+{
+    m_slots.clear();
+    m_size = 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void NodeIndex::rehash(size_t numSlots)
+{
+    std::vector<tSlot> oldSlots(numSlots, tSlot{ 0, NULL });
+    oldSlots.swap(m_slots);
+
+    size_t mask = numSlots - 1;
+    for (const tSlot& rSlot : oldSlots) {
+        if (rSlot.pNode != NULL) {
+            size_t i = rSlot.hash & mask;
+            while (m_slots[i].pNode != NULL) {
+                i = (i + 1) & mask;
+            }
+            m_slots[i] = rSlot;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,95 @@
+#include "../include/ObjectArena.h"
+
+#include <cassert>
+
+// size of the chunks that are requested from the system
+static const size_t CHUNK_BYTES = 64 * 1024;
+
+
+//-------------------------------------------------------------------------------------------------
+
+SlabPool::SlabPool(size_t objectSize, size_t alignment)
+    : m_pNext(NULL), m_pEnd(NULL), m_pFreeList(NULL), m_numObjects(0)
+{
+    // a released slot must be able to hold the free list link
+    if (alignment < alignof(void*)) {
+        alignment = alignof(void*);
+    }
+    size_t size = objectSize < sizeof(void*) ? sizeof(void*) : objectSize;
+    m_slotSize = (size + alignment - 1) / alignment * alignment;
+
+    m_slotsPerChunk = CHUNK_BYTES / m_slotSize;
+    if (m_slotsPerChunk < 16) {
+        m_slotsPerChunk = 16;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+SlabPool::~SlabPool()
+{
+    for (char* pChunk : m_chunks) {
+        ::operator delete(pChunk);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void* SlabPool::allocate()
+{
+    m_numObjects += 1;
+
+    // reuse released slots first
+    if (m_pFreeList != NULL) {
+        void* p = m_pFreeList;
+        m_pFreeList = *static_cast<void**>(p);
+        return p;
+    }
+
+    if (m_pNext == m_pEnd) {
+        char* pChunk = static_cast<char*>(::operator new(m_slotSize * m_slotsPerChunk));
+        m_chunks.push_back(pChunk);
+        m_pNext = pChunk;
+        m_pEnd = pChunk + m_slotSize * m_slotsPerChunk;
+    }
+
+    void* p = m_pNext;
+    m_pNext += m_slotSize;
+    return p;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void SlabPool::release(void* p)
+{
+    *static_cast<void**>(p) = m_pFreeList;
+    m_pFreeList = p;
+    m_numObjects -= 1;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+SlabPool& ObjectArena::getPool(const std::type_info& type, size_t size, size_t alignment)
+{
+    if (m_pLastType != NULL && *m_pLastType == type) {
+        return *m_pLastPool;
+    }
+
+    std::unique_ptr<SlabPool>& rpPool = m_pools[std::type_index(type)];
+    if (!rpPool) {
+        // destroy() must only be called for objects that were created by this arena
+        assert(size != 0);
+        rpPool.reset(new SlabPool(size, alignment));
+    }
+
+    m_pLastType = &type;
+    m_pLastPool = rpPool.get();
+    return *rpPool;
+}
+
+
+//-------------------------------------------------------------------------------------------------
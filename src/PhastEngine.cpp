@@ -0,0 +1,95 @@
+#include "../include/PhastEngine.h"
+
+#include <algorithm>
+#include <limits>
+
+const unsigned PhastEngine::MAX_SOURCES;
+
+
+//-------------------------------------------------------------------------------------------------
+
+PhastEngine::PhastEngine(const ContractionHierarchy& rHierarchy)
+    : m_rHierarchy(rHierarchy), m_context(rHierarchy.getGraph()), m_numSources(0)
+{
+    typedef ContractionHierarchy::tSearchArc tSearchArc;
+    tIndex numNodes = rHierarchy.getNumNodes();
+
+    m_position.resize(numNodes);
+    for (tIndex v = 0; v < numNodes; v++) {
+        m_position[v] = numNodes - 1 - rHierarchy.getRank(v);
+    }
+
+    std::vector<tIndex> order(numNodes);
+    for (tIndex v = 0; v < numNodes; v++) {
+        order[m_position[v]] = v;
+    }
+
+    // the downward arcs into a node come from higher ranked nodes, which the sweep visits earlier
+    m_firstArc.reserve(numNodes + 1);
+    m_arcs.reserve(rHierarchy.firstDown(numNodes));
+    m_firstArc.push_back(0);
+    for (tIndex v : order) {
+        for (tIndex i = rHierarchy.firstDown(v); i < rHierarchy.firstDown(v + 1); i++) {
+            const tSearchArc& rArc = rHierarchy.getDown(i);
+            tSweepArc arc = { m_position[rArc.node], rArc.weight };
+            m_arcs.push_back(arc);
+        }
+        m_firstArc.push_back(static_cast<tIndex>(m_arcs.size()));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void PhastEngine::run(tIndex src)
+{
+    run(std::vector<tIndex>(1, src));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void PhastEngine::run(const std::vector<tIndex>& rSources)
+{
+    if (rSources.size() > MAX_SOURCES) {
+        throw Graph::Exception("PHAST takes at most 16 sources per sweep");
+    }
+
+    const unsigned numSources = static_cast<unsigned>(rSources.size());
+    const tIndex numNodes = m_rHierarchy.getNumNodes();
+    m_numSources = numSources;
+    m_distances.assign(static_cast<size_t>(numNodes) * numSources, std::numeric_limits<double>::max());
+
+    for (unsigned k = 0; k < numSources; k++) {
+        m_rHierarchy.searchUpward(rSources[k], true, m_context, m_settled);
+        for (tIndex node : m_settled) {
+            m_distances[static_cast<size_t>(m_position[node]) * numSources + k] = m_context.getForwardSpace().getDistance(node);
+        }
+    }
+
+    double* pDistances = m_distances.data();
+    for (tIndex p = 0; p < numNodes; p++) {
+        double* pTo = pDistances + static_cast<size_t>(p) * numSources;
+        for (tIndex i = m_firstArc[p]; i < m_firstArc[p + 1]; i++) {
+            const double* pFrom = pDistances + static_cast<size_t>(m_arcs[i].tail) * numSources;
+            double weight = m_arcs[i].weight;
+            for (unsigned k = 0; k < numSources; k++) {
+                pTo[k] = std::min(pTo[k], pFrom[k] + weight);
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void PhastEngine::getDistances(unsigned source, std::vector<double>& rDistances) const
+{
+    rDistances.resize(m_position.size());
+    for (tIndex v = 0; v < m_position.size(); v++) {
+        rDistances[v] = getDistance(v, source);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
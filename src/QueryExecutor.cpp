@@ -0,0 +1,214 @@
+#include "../include/QueryExecutor.h"
+#include "../include/AStarEngine.h"
+#include "../include/BidirectionalDijkstraEngine.h"
+#include "../include/DijkstraEngine.h"
+
+#include <algorithm>
+
+const size_t QueryExecutor::TASK_SIZE;
+
+
+//-------------------------------------------------------------------------------------------------
+
+QueryExecutor::QueryExecutor(const CsrGraph& rGraph, unsigned numThreads, tAlgorithm algorithm)
+    : m_rGraph(rGraph), m_algorithm(algorithm), m_numQueued(0), m_numSteals(0), m_nextWorker(0), m_stop(false)
+{
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // all deques exist before the first worker looks for tasks to steal
+    for (unsigned thread = 0; thread < numThreads; thread++) {
+        m_workers.push_back(std::unique_ptr<tWorker>(new tWorker()));
+    }
+    for (unsigned thread = 0; thread < numThreads; thread++) {
+        m_workers[thread]->thread = std::thread(&QueryExecutor::workerLoop, this, thread);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+QueryExecutor::~QueryExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeUp.notify_all();
+
+    for (std::unique_ptr<tWorker>& rpWorker : m_workers) {
+        rpWorker->thread.join();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+std::future<void> QueryExecutor::submit(const std::vector<tQuery>& rQueries, std::vector<double>& rDistances,
+                                        std::vector<Graph::tEdges>* pPaths)
+{
+    for (const tQuery& rQuery : rQueries) {
+        if (rQuery.src >= m_rGraph.getNumNodes() || rQuery.dst >= m_rGraph.getNumNodes()) {
+            throw Graph::InvalidNodeException("query node is not in the routing snapshot");
+        }
+    }
+
+    std::shared_ptr<tBatch> pBatch(new tBatch());
+    pBatch->pQueries = &rQueries;
+    pBatch->pDistances = &rDistances;
+    pBatch->pPaths = pPaths;
+    pBatch->numOpenTasks = (rQueries.size() + TASK_SIZE - 1) / TASK_SIZE;
+    pBatch->failed = false;
+    std::future<void> result = pBatch->done.get_future();
+
+    rDistances.resize(rQueries.size());
+    if (pPaths != NULL) {
+        pPaths->resize(rQueries.size());
+    }
+    if (rQueries.empty()) {
+        pBatch->done.set_value();
+        return result;
+    }
+
+    // deal the tasks out in runs, so that every worker starts on consecutive queries
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t numTasks = pBatch->numOpenTasks;
+        size_t perWorker = (numTasks + m_workers.size() - 1) / m_workers.size();
+        for (size_t task = 0; task < numTasks; task++) {
+            tWorker& rWorker = *m_workers[m_nextWorker];
+            tTask newTask = { pBatch, task * TASK_SIZE, std::min((task + 1) * TASK_SIZE, rQueries.size()) };
+            {
+                std::lock_guard<std::mutex> dequeLock(rWorker.mutex);
+                rWorker.tasks.push_back(newTask);
+                m_numQueued += 1;
+            }
+            if ((task + 1) % perWorker == 0) {
+                m_nextWorker = (m_nextWorker + 1) % m_workers.size();
+            }
+        }
+    }
+    m_wakeUp.notify_all();
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void QueryExecutor::workerLoop(unsigned thread)
+{
+    while (true) {
+        tTask task;
+        if (takeTask(thread, task)) {
+            runTask(thread, task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeUp.wait(lock, [this]() { return m_stop || m_numQueued > 0; });
+        if (m_numQueued == 0) {
+            // stopped, and the queued batches are done
+            return;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+bool QueryExecutor::takeTask(unsigned thread, tTask& rTask)
+{
+    {
+        tWorker& rOwn = *m_workers[thread];
+        std::lock_guard<std::mutex> lock(rOwn.mutex);
+        if (!rOwn.tasks.empty()) {
+            rTask = std::move(rOwn.tasks.front());
+            rOwn.tasks.pop_front();
+            m_numQueued -= 1;
+            return true;
+        }
+    }
+
+    // steal the last task of another worker, the one that it would run last
+    for (size_t i = 1; i < m_workers.size(); i++) {
+        tWorker& rVictim = *m_workers[(thread + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(rVictim.mutex);
+        if (!rVictim.tasks.empty()) {
+            rTask = std::move(rVictim.tasks.back());
+            rVictim.tasks.pop_back();
+            m_numQueued -= 1;
+            m_numSteals += 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void QueryExecutor::runTask(unsigned thread, const tTask& rTask)
+{
+    tBatch& rBatch = *rTask.pBatch;
+    tWorker& rWorker = *m_workers[thread];
+
+    try {
+        if (!rWorker.pContext) {
+            rWorker.pContext.reset(new RoutingContext());
+            rWorker.pContext->reserve(m_rGraph, m_algorithm == ALGORITHM_BIDIRECTIONAL);
+        }
+        for (size_t i = rTask.begin; i < rTask.end && !rBatch.failed; i++) {
+            runQuery(*rWorker.pContext, (*rBatch.pQueries)[i], (*rBatch.pDistances)[i],
+                     rBatch.pPaths != NULL ? &(*rBatch.pPaths)[i] : NULL);
+        }
+    } catch (...) {
+        if (!rBatch.failed.exchange(true)) {
+            rBatch.pException = std::current_exception();
+        }
+    }
+
+    // the last task of the batch completes the future
+    if (rBatch.numOpenTasks.fetch_sub(1) == 1) {
+        if (rBatch.failed) {
+            rBatch.done.set_exception(rBatch.pException);
+        } else {
+            rBatch.done.set_value();
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void QueryExecutor::runQuery(RoutingContext& rContext, const tQuery& rQuery, double& rDistance,
+                             Graph::tEdges* pPath) const
+{
+    if (m_algorithm == ALGORITHM_BIDIRECTIONAL) {
+        BidirectionalDijkstraEngine engine(m_rGraph, rContext);
+        engine.run(rQuery.src, rQuery.dst);
+        rDistance = engine.getDistance();
+        if (pPath != NULL) {
+            engine.getPath(*pPath);
+        }
+    } else if (m_algorithm == ALGORITHM_ASTAR) {
+        AStarEngine engine(m_rGraph, rContext);
+        engine.run(rQuery.src, rQuery.dst);
+        rDistance = engine.getDistance(rQuery.dst);
+        if (pPath != NULL) {
+            engine.getPath(rQuery.dst, *pPath);
+        }
+    } else {
+        DijkstraEngine engine(m_rGraph, rContext);
+        engine.run(rQuery.src, rQuery.dst);
+        rDistance = engine.getDistance(rQuery.dst);
+        if (pPath != NULL) {
+            engine.getPath(rQuery.dst, *pPath);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
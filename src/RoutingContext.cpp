@@ -0,0 +1,17 @@
+#include "../include/RoutingContext.h"
+
+//-------------------------------------------------------------------------------------------------
+
+void RoutingContext::reserve(const CsrGraph& rGraph, bool withBackward)
+{
+    if (m_forwardSpace.size() != rGraph.getNumNodes()) {
+        m_forwardSpace.resize(rGraph.getNumNodes());
+    }
+
+    if (withBackward && m_backwardSpace.size() != rGraph.getNumNodes()) {
+        m_backwardSpace.resize(rGraph.getNumNodes());
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
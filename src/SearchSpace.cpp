@@ -0,0 +1,72 @@
+#include "../include/SearchSpace.h"
+
+#include <algorithm>
+
+//-------------------------------------------------------------------------------------------------
+
+SearchSpace::SearchSpace(tIndex numNodes) : m_round(2)
+{
+    resize(numNodes);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void SearchSpace::resize(tIndex numNodes)
+{
+    tEntry unreached = { 0.0, CsrGraph::INVALID_INDEX, 0 };
+    m_entries.assign(numNodes, unreached);
+    m_round = 2;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void SearchSpace::clear()
+{
+    // every search uses two stamp values (reached and settled)
+    m_round += 2;
+
+    // reset the stamps when the counter overflows, which happens once in 2^31 searches
+    if (m_round >= 0xFFFFFFF0u) {
+        for (tEntry& rEntry : m_entries) {
+            rEntry.stamp = 0;
+        }
+        m_round = 2;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath SearchSpace::getPath(const CsrGraph& rGraph, tIndex dst) const
+{
+    Graph::tPath path;
+
+    tIndex e = getPrevEdge(dst);
+    while (e != CsrGraph::INVALID_INDEX) {
+        path.push_front(rGraph.getEdge(e));
+        e = getPrevEdge(rGraph.getTail(e));
+    }
+
+    return path;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void SearchSpace::getPath(const CsrGraph& rGraph, tIndex dst, Graph::tEdges& rPath) const
+{
+    rPath.clear();
+
+    // collect the edges from dst back to the source and turn them around
+    tIndex e = getPrevEdge(dst);
+    while (e != CsrGraph::INVALID_INDEX) {
+        rPath.push_back(rGraph.getEdge(e));
+        e = getPrevEdge(rGraph.getTail(e));
+    }
+    std::reverse(rPath.begin(), rPath.end());
+}
+
+
+//-------------------------------------------------------------------------------------------------
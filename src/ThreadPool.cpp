@@ -0,0 +1,131 @@
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+
+//-------------------------------------------------------------------------------------------------
+
+ThreadPool::ThreadPool(unsigned numThreads)
+    : m_generation(0), m_numBusy(0), m_stop(false), m_pBody(NULL), m_size(0), m_grainSize(1), m_next(0)
+{
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned thread = 1; thread < numThreads; thread++) {
+        m_workers.push_back(std::thread(&ThreadPool::workerLoop, this, thread));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeUp.notify_all();
+
+    for (std::thread& rWorker : m_workers) {
+        rWorker.join();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ThreadPool::parallelFor(size_t n, const tLoopBody& body, size_t grainSize)
+{
+    if (n == 0) {
+        return;
+    }
+
+    // small loops are not worth waking the workers
+    if (m_workers.empty() || n <= grainSize) {
+        for (size_t i = 0; i < n; i++) {
+            body(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pBody = &body;
+        m_size = n;
+        m_grainSize = std::max<size_t>(1, grainSize);
+        m_next = 0;
+        m_pException = std::exception_ptr();
+        m_numBusy = static_cast<unsigned>(m_workers.size());
+        m_generation += 1;
+    }
+    m_wakeUp.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_numBusy == 0; });
+    m_pBody = NULL;
+
+    if (m_pException) {
+        std::rethrow_exception(m_pException);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ThreadPool::workerLoop(unsigned thread)
+{
+    unsigned generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [&]() { return m_stop || m_generation != generation; });
+            if (m_stop) {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        work(thread);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_numBusy -= 1;
+        if (m_numBusy == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void ThreadPool::work(unsigned thread)
+{
+    while (true) {
+        size_t begin = m_next.fetch_add(m_grainSize);
+        if (begin >= m_size) {
+            return;
+        }
+
+        size_t end = std::min(begin + m_grainSize, m_size);
+        try {
+            for (size_t i = begin; i < end; i++) {
+                (*m_pBody)(i, thread);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_pException) {
+                m_pException = std::current_exception();
+            }
+
+            // skip the remaining chunks
+            m_next = m_size;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
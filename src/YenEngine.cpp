@@ -0,0 +1,292 @@
+#include "../include/YenEngine.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+
+//-------------------------------------------------------------------------------------------------
+
+YenEngine::YenEngine(const CsrGraph& rGraph, unsigned numThreads)
+    : m_rGraph(rGraph), m_pool(numThreads), m_workspaces(m_pool.getNumThreads()), m_dst(CsrGraph::INVALID_INDEX)
+{
+    m_treeContext.reserve(rGraph, true);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t YenEngine::run(tIndex src, tIndex dst, size_t k)
+{
+    m_paths.clear();
+    m_costs.clear();
+    for (std::unique_ptr<tWorkspace>& rpWorkspace : m_workspaces) {
+        if (rpWorkspace) {
+            rpWorkspace->numSearches = 0;
+        }
+    }
+    if (k == 0) {
+        return 0;
+    }
+
+    buildTree(dst);
+    if (getTreeDistance(src) == std::numeric_limits<double>::max()) {
+        return 0;
+    }
+
+    // the first path is the tree path of the source
+    std::vector<tIndex> first;
+    for (tIndex v = src; v != dst; v = m_rGraph.getHead(first.back())) {
+        first.push_back(m_treeContext.getBackwardSpace().getPrevEdge(v));
+    }
+    m_paths.push_back(first);
+    m_costs.push_back(getCost(first));
+
+    std::multimap<double, std::vector<tIndex> > candidates;
+    std::set<std::vector<tIndex> > known;
+    known.insert(first);
+
+    while (m_paths.size() < k) {
+        // only the cheapest k - found candidates can still be accepted, so spur paths that cost
+        // at least as much as the last of them are not needed
+        size_t numNeeded = k - m_paths.size();
+        double limit = std::numeric_limits<double>::max();
+        if (candidates.size() >= numNeeded) {
+            std::multimap<double, std::vector<tIndex> >::const_iterator it = candidates.begin();
+            std::advance(it, numNeeded - 1);
+            limit = it->first;
+        }
+
+        const std::vector<tIndex>& rLast = m_paths.back();
+        m_spurs.resize(rLast.size());
+        m_pool.parallelFor(rLast.size(), [&](size_t i, unsigned thread) {
+            std::unique_ptr<tWorkspace>& rpWorkspace = m_workspaces[thread];
+            if (!rpWorkspace) {
+                rpWorkspace.reset(new tWorkspace());
+                rpWorkspace->context.reserve(m_rGraph);
+                rpWorkspace->bannedNode.assign(m_rGraph.getNumNodes(), 0);
+                rpWorkspace->bannedEdge.assign(m_rGraph.getNumEdges(), 0);
+                rpWorkspace->stamp = 0;
+                rpWorkspace->numSearches = 0;
+            }
+            findSpur(rLast, i, limit, *rpWorkspace, m_spurs[i]);
+        }, 1);
+
+        for (tCandidate& rSpur : m_spurs) {
+            if (!rSpur.edges.empty() && known.insert(rSpur.edges).second) {
+                candidates.insert(std::make_pair(rSpur.cost, std::move(rSpur.edges)));
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+
+        m_paths.push_back(std::move(candidates.begin()->second));
+        m_costs.push_back(candidates.begin()->first);
+        candidates.erase(candidates.begin());
+    }
+
+    return m_paths.size();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void YenEngine::buildTree(tIndex dst)
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    SearchSpace& rSpace = m_treeContext.getBackwardSpace();
+    RoutingContext::tHeap& rHeap = m_treeContext.getBackwardHeap();
+    rSpace.clear();
+    rHeap.clear();
+    m_dst = dst;
+
+    rSpace.update(dst, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(0.0, dst));
+
+    // the predecessor edge of a node is the first edge of its tree path to dst
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tIndex u = rHeap.back().second;
+        rHeap.pop_back();
+        if (rSpace.isSettled(u)) {
+            continue;
+        }
+        rSpace.settle(u);
+
+        double distU = rSpace.getDistance(u);
+        for (tIndex i = m_rGraph.firstIn(u); i < m_rGraph.firstIn(u + 1); i++) {
+            tIndex e = m_rGraph.getInEdge(i);
+            tIndex v = m_rGraph.getTail(e);
+            double newDistance = distU + m_rGraph.getWeight(e);
+            if (newDistance < rSpace.getDistance(v)) {
+                rSpace.update(v, newDistance, e);
+                rHeap.push_back(tHeapEntry(newDistance, v));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void YenEngine::findSpur(const std::vector<tIndex>& rPath, size_t i, double limit, tWorkspace& rWorkspace,
+                         tCandidate& rResult) const
+{
+    typedef RoutingContext::tHeapEntry tHeapEntry;
+    std::greater<tHeapEntry> compare;
+
+    rResult.edges.clear();
+    tIndex spur = m_rGraph.getTail(rPath[i]);
+    double rootCost = 0.0;
+    for (size_t j = 0; j < i; j++) {
+        rootCost += m_rGraph.getWeight(rPath[j]);
+    }
+    double bound = limit - rootCost;
+    if (getTreeDistance(spur) >= bound) {
+        return;
+    }
+
+    if (++rWorkspace.stamp == 0) {
+        std::fill(rWorkspace.bannedNode.begin(), rWorkspace.bannedNode.end(), 0);
+        std::fill(rWorkspace.bannedEdge.begin(), rWorkspace.bannedEdge.end(), 0);
+        rWorkspace.stamp = 1;
+    }
+    const uint32_t stamp = rWorkspace.stamp;
+    for (size_t j = 0; j < i; j++) {
+        rWorkspace.bannedNode[m_rGraph.getTail(rPath[j])] = stamp;
+    }
+    for (const std::vector<tIndex>& rAccepted : m_paths) {
+        if (rAccepted.size() > i && std::equal(rPath.begin(), rPath.begin() + i, rAccepted.begin())) {
+            rWorkspace.bannedEdge[rAccepted[i]] = stamp;
+        }
+    }
+
+    rResult.edges.assign(rPath.begin(), rPath.begin() + i);
+
+    // the tree path is the shortest spur path, if the spur may take it
+    bool treePathAllowed = rWorkspace.bannedEdge[m_treeContext.getBackwardSpace().getPrevEdge(spur)] != stamp;
+    for (tIndex v = spur; treePathAllowed && v != m_dst; ) {
+        tIndex e = m_treeContext.getBackwardSpace().getPrevEdge(v);
+        v = m_rGraph.getHead(e);
+        treePathAllowed = rWorkspace.bannedNode[v] != stamp;
+    }
+    if (treePathAllowed) {
+        for (tIndex v = spur; v != m_dst; v = m_rGraph.getHead(rResult.edges.back())) {
+            rResult.edges.push_back(m_treeContext.getBackwardSpace().getPrevEdge(v));
+        }
+        rResult.cost = getCost(rResult.edges);
+        return;
+    }
+
+    // A* with the exact tree distances of the unrestricted graph as heuristic
+    SearchSpace& rSpace = rWorkspace.context.getForwardSpace();
+    RoutingContext::tHeap& rHeap = rWorkspace.context.getForwardHeap();
+    rSpace.clear();
+    rHeap.clear();
+    rWorkspace.numSearches += 1;
+
+    rSpace.update(spur, 0.0, CsrGraph::INVALID_INDEX);
+    rHeap.push_back(tHeapEntry(getTreeDistance(spur), spur));
+
+    bool found = false;
+    while (!rHeap.empty()) {
+        std::pop_heap(rHeap.begin(), rHeap.end(), compare);
+        tHeapEntry top = rHeap.back();
+        rHeap.pop_back();
+        tIndex u = top.second;
+        if (rSpace.isSettled(u)) {
+            continue;
+        }
+        if (top.first >= bound) {
+            break;
+        }
+        rSpace.settle(u);
+        if (u == m_dst) {
+            found = true;
+            break;
+        }
+
+        double distU = rSpace.getDistance(u);
+        for (tIndex e = m_rGraph.firstOut(u); e < m_rGraph.firstOut(u + 1); e++) {
+            tIndex v = m_rGraph.getHead(e);
+            double estimate = getTreeDistance(v);
+            if (rWorkspace.bannedEdge[e] == stamp || rWorkspace.bannedNode[v] == stamp
+                || estimate == std::numeric_limits<double>::max()) {
+                continue;
+            }
+            double newDistance = distU + m_rGraph.getWeight(e);
+            if (newDistance < rSpace.getDistance(v)) {
+                rSpace.update(v, newDistance, e);
+                rHeap.push_back(tHeapEntry(newDistance + estimate, v));
+                std::push_heap(rHeap.begin(), rHeap.end(), compare);
+            }
+        }
+    }
+
+    if (!found) {
+        rResult.edges.clear();
+        return;
+    }
+    size_t rootSize = rResult.edges.size();
+    for (tIndex v = m_dst; v != spur; v = m_rGraph.getTail(rSpace.getPrevEdge(v))) {
+        rResult.edges.push_back(rSpace.getPrevEdge(v));
+    }
+    std::reverse(rResult.edges.begin() + rootSize, rResult.edges.end());
+    rResult.cost = getCost(rResult.edges);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+double YenEngine::getCost(const std::vector<tIndex>& rEdges) const
+{
+    double cost = 0.0;
+    for (tIndex e : rEdges) {
+        cost += m_rGraph.getWeight(e);
+    }
+    return cost;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+Graph::tPath YenEngine::getPath(size_t i) const
+{
+    Graph::tPath path;
+    for (tIndex e : m_paths[i]) {
+        path.push_back(m_rGraph.getEdge(e));
+    }
+    return path;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+void YenEngine::getPath(size_t i, Graph::tEdges& rPath) const
+{
+    rPath.clear();
+    for (tIndex e : m_paths[i]) {
+        rPath.push_back(m_rGraph.getEdge(e));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+
+size_t YenEngine::getNumSpurSearches() const
+{
+    size_t numSearches = 0;
+    for (const std::unique_ptr<tWorkspace>& rpWorkspace : m_workspaces) {
+        numSearches += rpWorkspace ? rpWorkspace->numSearches : 0;
+    }
+    return numSearches;
+}
+
+
+//-------------------------------------------------------------------------------------------------
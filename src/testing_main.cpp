@@ -2,13 +2,37 @@
 #define TESTING
 #include "../include/Graph.h"
 #include "../include/SimpleEdge.h"
+#include "../include/CsrGraph.h"
+#include "../include/DijkstraEngine.h"
+#include "../include/RoutingContext.h"
+#include "../include/AStarEngine.h"
+#include "../include/AlternativeRouteEngine.h"
+#include "../include/BidirectionalDijkstraEngine.h"
+#include "../include/ContractionHierarchy.h"
+#include "../include/DeltaSteppingEngine.h"
+#include "../include/FixedPointDijkstraEngine.h"
+#include "../include/HubLabels.h"
+#include "../include/LandmarkTable.h"
+#include "../include/MultilevelOverlay.h"
+#include "../include/PhastEngine.h"
+#include "../include/PriorityQueues.h"
+#include "../include/QueryExecutor.h"
+#include "../include/YenEngine.h"
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <string>
 #include <fstream>
+#include <limits>
+#include <set>
 #include <sstream>
+#include <thread>
 #include "../include/GeoJSONGraphConverter.h"
 #include "../include/Graph.h" 
+#ifdef __linux__
+#include <unistd.h>
+#endif
 /*-----------------------------------------------------------------------------------------------*/
 
 template <class T>
@@ -22,6 +46,66 @@ double getExecutionSpeed(T func)
 }
 
 
+/*-----------------------------------------------------------------------------------------------*/
+
+/* Resident set size of this process in MB, or -1 if it is not available on this platform. */
+double getResidentMemoryMB()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, residentPages = 0;
+    if (statm >> pages >> residentPages) {
+        return residentPages * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+    }
+#endif
+    return -1.0;
+}
+
+
+/* Builds a bidirectional grid graph with size x size nodes and unit weights. */
+void makeGridGraph(Graph& g, int size)
+{
+    std::vector<Node*> nodes;
+    nodes.reserve(size * size);
+    g.reserveNodes(size * size);
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            nodes.push_back(&g.makeNode(Node(std::to_string(x) + "_" + std::to_string(y), x, y)));
+        }
+    }
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            if (x + 1 < size) g.makeBiEdge<SimpleEdge>(*nodes[y * size + x], *nodes[y * size + x + 1], 1.0);
+            if (y + 1 < size) g.makeBiEdge<SimpleEdge>(*nodes[y * size + x], *nodes[(y + 1) * size + x], 1.0);
+        }
+    }
+}
+
+
+/* Imports a road grid with size x size crossings around Beijing as GeoJSON, so that the weights are km. */
+void makeGeoGridGraph(Graph& g, int size)
+{
+    std::ostringstream geojson;
+    geojson << "{\"type\": \"FeatureCollection\", \"features\": [";
+    for (int i = 0; i < size; i++) {
+        for (int dir = 0; dir < 2; dir++) {
+            geojson << (i + dir > 0 ? "," : "") << "{\"type\": \"Feature\", \"geometry\": {\"type\": \"LineString\", \"coordinates\": [";
+            for (int j = 0; j < size; j++) {
+                double lon = 116.3 + 0.001 * (dir == 0 ? j : i);
+                double lat = 39.9 + 0.001 * (dir == 0 ? i : j);
+                geojson << (j > 0 ? "," : "") << "[" << lon << "," << lat << "]";
+            }
+            geojson << "]}}";
+        }
+    }
+    geojson << "]}";
+
+    GeoJSONGraphConverter::fromGeoJSON(g, geojson.str());
+}
+
+
 /*-----------------------------------------------------------------------------------------------*/
 
 class GraphTesting {
@@ -88,6 +172,479 @@ public:
     }
 
 
+    /* TEST: The neighbours of a node should follow its edges, also after an edge was removed */
+    void testNeighbours()
+    {
+        std::cout << "testNeighbours: ";
+
+        Graph graph;
+        Node& rA = graph.makeNode<Node>("A");
+        Node& rB = graph.makeNode<Node>("B");
+        Node& rC = graph.makeNode<Node>("C");
+        graph.makeBiEdge<SimpleEdge>(rA, rB, 1.0);
+        Edge& rAC = graph.makeEdge<SimpleEdge>(rA, rC, 2.0);
+        graph.makeEdge<SimpleEdge>(rC, rA, 2.0);
+
+        size_t numBoth = 0, numOut = 0;
+        for (Node* pNode : rA.getNeighbours()) numBoth += (pNode == &rB || pNode == &rC) ? 1 : 0;
+        for (Node* pNode : rA.getNeighbours(Node::DIR_OUT)) numOut += pNode != NULL ? 1 : 0;
+        if (numBoth != 4 || numOut != 2) {
+            std::cout << "Wrong neighbours!" << std::endl;
+            return;
+        }
+
+        graph.remove(rAC);
+        if (rA.getOutEdges().size() != 1 || &rA.getOutEdges()[0]->getDstNode() != &rB || rC.getInEdges().size() != 0) {
+            std::cout << "Wrong adjacency after removing an edge!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: Routing on the CSR snapshot should find the same path */
+    void testCsrRouting()
+    {
+        std::cout << "testCsrRouting: ";
+
+        CsrGraph csr = g.freeze();
+        ContractionHierarchy ch(csr);
+        LandmarkTable landmarks(csr);
+        MultilevelOverlay::tOptions overlayOptions;
+        overlayOptions.cellSizes.assign(1, 2);
+        overlayOptions.cellSizes.push_back(4);
+        MultilevelOverlay overlay(csr, overlayOptions);
+        HubLabels hubLabels(ch);
+        RoutingContext context;
+        Graph::tEdges path;
+        for (Node* pSrc : g.m_nodes) {
+            for (Node* pDst : g.m_nodes) {
+                Graph::tPath expected = g.findShortestPathDijkstra(*pSrc, *pDst, true);
+                csr.findShortestPathDijkstra(*pSrc, *pDst, context, path);
+                if (csr.findShortestPathDijkstra(*pSrc, *pDst) != expected
+                    || csr.findShortestPathBidirectional(*pSrc, *pDst) != expected
+                    || ch.findShortestPath(*pSrc, *pDst) != expected
+                    || csr.findShortestPathALT(*pSrc, *pDst, landmarks) != expected
+                    || overlay.findShortestPath(*pSrc, *pDst) != expected
+                    || hubLabels.findShortestPath(*pSrc, *pDst) != expected
+                    || path.size() != expected.size() || !std::equal(path.begin(), path.end(), expected.begin())) {
+                    std::cout << "Different path from " << pSrc->getId() << " to " << pDst->getId() << "!" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+
+    /* TEST: The distance matrices should hold the lengths of the shortest paths */
+    void testDistanceMatrix()
+    {
+        std::cout << "testDistanceMatrix: ";
+
+        CsrGraph csr = g.freeze();
+        ContractionHierarchy ch(csr);
+        std::vector<Node*> pNodes(g.m_nodes.begin(), g.m_nodes.end());
+        std::vector<CsrGraph::tIndex> nodes;
+        for (Node* pNode : pNodes) {
+            nodes.push_back(csr.getIndex(*pNode));
+        }
+
+        std::vector<double> dijkstraMatrix = csr.computeDistanceMatrix(nodes, nodes, 2);
+        std::vector<double> chMatrix = ch.computeDistanceMatrix(nodes, nodes, 2);
+        PhastEngine phast(ch);
+        DeltaSteppingEngine deltaStepping(csr, 100.0, 2);
+        for (size_t i = 0; i < nodes.size(); i++) {
+            phast.run(nodes[i]);
+            deltaStepping.run(nodes[i]);
+            for (size_t j = 0; j < nodes.size(); j++) {
+                Graph::tPath path = g.findShortestPathDijkstra(*pNodes[i], *pNodes[j], true);
+                double expected = (path.empty() && i != j) ? std::numeric_limits<double>::max() : 0.0;
+                for (Edge* pEdge : path) {
+                    expected += pEdge->getWeight();
+                }
+                if (dijkstraMatrix[i * nodes.size() + j] != expected || chMatrix[i * nodes.size() + j] != expected
+                    || phast.getDistance(nodes[j]) != expected || deltaStepping.getDistance(nodes[j]) != expected) {
+                    std::cout << "Wrong distance from " << pNodes[i]->getId() << " to " << pNodes[j]->getId() << "!" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: findReachable should return the nodes within the budget and the edges that leave it */
+    void testReachable()
+    {
+        std::cout << "testReachable: ";
+
+        CsrGraph csr = g.freeze();
+        for (Node* pSrc : g.m_nodes) {
+            CsrGraph::tDistances expected = csr.findDistancesDijkstra(csr.getIndex(*pSrc));
+            for (double budget : {0.0, 450.0, 1000.0, 1500.0}) {
+                CsrGraph::tReachable reachable = csr.findReachable(*pSrc, budget);
+                size_t numReachable = 0, numPartial = 0;
+                for (CsrGraph::tIndex e = 0; e < csr.getNumEdges(); e++) {
+                    double distance = expected.distance[csr.getTail(e)];
+                    numPartial += (distance < budget && distance + csr.getWeight(e) > budget) ? 1 : 0;
+                }
+                for (CsrGraph::tIndex v = 0; v < csr.getNumNodes(); v++) {
+                    numReachable += (expected.distance[v] <= budget) ? 1 : 0;
+                }
+                bool correct = reachable.nodes.size() == numReachable && reachable.partialEdges.size() == numPartial;
+                for (size_t i = 0; correct && i < reachable.nodes.size(); i++) {
+                    correct = reachable.distance[i] == expected.distance[reachable.nodes[i]];
+                }
+                if (!correct) {
+                    std::cout << "Wrong reachable nodes from " << pSrc->getId() << " within " << budget << "!" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        // the isochrone of a grid is a polygon
+        Graph grid;
+        makeGeoGridGraph(grid, 10);
+        CsrGraph gridCsr = grid.freeze();
+        CsrGraph::tReachable reachable = gridCsr.findReachable(*gridCsr.getNode(0), 0.5);
+        nlohmann::json isochrone = nlohmann::json::parse(GeoJSONGraphConverter::toIsochrone(gridCsr, reachable));
+        if (isochrone["geometry"]["type"] != "Polygon") {
+            std::cout << "The isochrone is no polygon!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The k shortest paths should be distinct loopless paths in the order of their costs */
+    void testKShortestPaths()
+    {
+        std::cout << "testKShortestPaths: ";
+
+        Graph grid;
+        makeGeoGridGraph(grid, 5);
+        CsrGraph csr = grid.freeze();
+        CsrGraph::tIndex src = 0, dst = csr.getNumNodes() - 1;
+        std::vector<CsrGraph::tRoute> routes = csr.findKShortestPaths(*csr.getNode(src), *csr.getNode(dst), 20, 2);
+
+        CsrGraph::tDistances distances = csr.findDistancesDijkstra(src);
+        bool correct = routes.size() == 20 && std::fabs(routes[0].cost - distances.distance[dst]) < 1e-9;
+        std::set<Graph::tPath> distinct;
+        for (size_t i = 0; correct && i < routes.size(); i++) {
+            std::set<Node*> visited;
+            Node* pNode = csr.getNode(src);
+            visited.insert(pNode);
+            double cost = 0.0;
+            for (Edge* pEdge : routes[i].path) {
+                correct = correct && &pEdge->getSrcNode() == pNode && visited.insert(&pEdge->getDstNode()).second;
+                pNode = &pEdge->getDstNode();
+                cost += pEdge->getWeight();
+            }
+            correct = correct && pNode == csr.getNode(dst) && cost == routes[i].cost && distinct.insert(routes[i].path).second
+                && (i == 0 || routes[i - 1].cost <= routes[i].cost);
+        }
+        if (!correct) {
+            std::cout << "Wrong k shortest paths!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: Dijkstra with every priority queue policy should find the distances of the binary heap */
+    void testPriorityQueues()
+    {
+        std::cout << "testPriorityQueues: ";
+
+        // integer weights on the sample graph, km with a fractional part on the grid
+        Graph grid;
+        makeGeoGridGraph(grid, 20);
+        CsrGraph sample = g.freeze();
+        CsrGraph geo = grid.freeze();
+        for (const CsrGraph* pCsr : {&sample, &geo}) {
+            double scale = pCsr == &sample ? 1.0 : 100.0;
+            DijkstraEngine engine(*pCsr);
+            QuaternaryHeapQueue quaternary;
+            RadixHeapQueue radix(scale);
+            DialQueue dial(*pCsr, scale);
+            for (CsrGraph::tIndex src = 0; src < pCsr->getNumNodes(); src += 7) {
+                CsrGraph::tDistances expected = pCsr->findDistancesDijkstra(src);
+                for (int queue = 0; queue < 3; queue++) {
+                    if (queue == 0) engine.run(src, quaternary);
+                    if (queue == 1) engine.run(src, radix);
+                    if (queue == 2) engine.run(src, dial);
+                    for (CsrGraph::tIndex v = 0; v < pCsr->getNumNodes(); v++) {
+                        if (engine.getDistance(v) != expected.distance[v]) {
+                            std::cout << "Wrong distance with queue " << queue << "!" << std::endl;
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The fixed point distances should be the sums of the rounded weights along the path */
+    void testFixedPointWeights()
+    {
+        std::cout << "testFixedPointWeights: ";
+
+        // the sample weights are whole km, the grid weights are rounded to meters
+        Graph grid;
+        makeGeoGridGraph(grid, 20);
+        CsrGraph sample = g.freeze(1.0);
+        CsrGraph geo = grid.freeze(1e-3);
+        for (const CsrGraph* pCsr : {&sample, &geo}) {
+            FixedPointDijkstraEngine engine(*pCsr);
+            for (CsrGraph::tIndex src = 0; src < pCsr->getNumNodes(); src += 7) {
+                CsrGraph::tDistances expected = pCsr->findDistancesDijkstra(src);
+                engine.run(src);
+                for (CsrGraph::tIndex v = 0; v < pCsr->getNumNodes(); v++) {
+                    Graph::tPath path = engine.getPath(v);
+                    double rounded = 0.0;
+                    for (Edge* pEdge : path) {
+                        rounded += std::floor(pEdge->getWeight() / pCsr->getWeightUnit() + 0.5);
+                    }
+                    // every edge of either shortest path is off by at most half a unit
+                    size_t numEdges = std::max(path.size(), pCsr->unpackPath(expected, v).size());
+                    double error = std::fabs(engine.getDistance(v) - expected.distance[v]);
+                    if (engine.getFixedDistance(v) != rounded || error > 0.5 * pCsr->getWeightUnit() * numEdges) {
+                        std::cout << "Wrong fixed point distance!" << std::endl;
+                        return;
+                    }
+                }
+            }
+        }
+
+        bool thrown = false;
+        try {
+            g.freeze(1e-9);
+        } catch (Graph::Exception&) {
+            thrown = true;
+        }
+        if (!thrown) {
+            std::cout << "Weight overflow not detected!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The devirtualized Dijkstra should find the distances of the virtual one and reject other edge types */
+    void testDevirtualizedWeights()
+    {
+        std::cout << "testDevirtualizedWeights: ";
+
+        for (Node* pSrc : g.m_nodes) {
+            Node* pFound = NULL;
+            Graph::tDijkstraMap expected = g.runDijkstraV1<Edge>(*pSrc, NULL, &pFound);
+            Graph::tDijkstraMap actual = g.findDistancesDijkstraV1<SimpleEdge>(*pSrc, NULL, &pFound);
+            for (Node* pNode : g.m_nodes) {
+                if (actual[pNode].distance != expected[pNode].distance || actual[pNode].prevEdge != expected[pNode].prevEdge) {
+                    std::cout << "Wrong distance from " << pSrc->getId() << " to " << pNode->getId() << "!" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        // a graph with another edge type falls back to the virtual call
+        struct TollEdge : public Edge {
+            TollEdge(Node& rSrc, Node& rDst) : Edge(rSrc, rDst) { }
+            virtual double getWeight() const { return 2.0; }
+        };
+        Graph mixed;
+        Node& rA = mixed.makeNode<Node>("a");
+        Node& rB = mixed.makeNode<Node>("b");
+        Node& rC = mixed.makeNode<Node>("c");
+        mixed.makeEdge<SimpleEdge>(rA, rB, 1.0);
+        mixed.makeEdge<TollEdge>(rB, rC);
+        Node* pFound = NULL;
+        bool thrown = false;
+        try {
+            mixed.findDistancesDijkstraV1<SimpleEdge>(rA, NULL, &pFound);
+        } catch (Graph::Exception&) {
+            thrown = true;
+        }
+        if (!thrown || mixed.hasOnlyEdgesOf<SimpleEdge>() || !g.hasOnlyEdgesOf<SimpleEdge>()
+            || mixed.findDistancesDijkstraV1(rA, NULL, &pFound)[&rC].distance != 3.0) {
+            std::cout << "Wrong edge type dispatch!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: A metric of a snapshot should route like a graph that was built with its weights */
+    void testMetrics()
+    {
+        std::cout << "testMetrics: ";
+
+        Graph grid;
+        makeGeoGridGraph(grid, 20);
+        CsrGraph csr = grid.freeze();
+        CsrGraph::tMetric time = csr.addMetric("time", [&csr](CsrGraph::tIndex e) { return csr.getWeight(e) * (1 + e % 3); });
+
+        // the same network with the time as weights
+        Graph timeGrid;
+        for (CsrGraph::tIndex v = 0; v < csr.getNumNodes(); v++) {
+            timeGrid.makeNode<Node>(csr.getNode(v)->getId());
+        }
+        for (CsrGraph::tIndex e = 0; e < csr.getNumEdges(); e++) {
+            timeGrid.makeEdge<SimpleEdge>(*timeGrid.findNodeById(csr.getNode(csr.getTail(e))->getId()),
+                                          *timeGrid.findNodeById(csr.getNode(csr.getHead(e))->getId()), csr.getWeight(e, time));
+        }
+        CsrGraph timeCsr = timeGrid.freeze();
+
+        DijkstraEngine engine(csr);
+        for (CsrGraph::tIndex src = 0; src < csr.getNumNodes(); src += 7) {
+            CsrGraph::tDistances expected = timeCsr.findDistancesDijkstra(src);
+            engine.run(src, CsrGraph::INVALID_INDEX, MetricWeight(csr, time));
+            for (CsrGraph::tIndex v = 0; v < csr.getNumNodes(); v++) {
+                if (engine.getDistance(v) != expected.distance[v]) {
+                    std::cout << "Wrong distance in the time metric!" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        Graph::tPath path = csr.findShortestPathDijkstra(*csr.getNode(0), *csr.getNode(csr.getNumNodes() - 1), time);
+        double cost = 0.0;
+        for (Edge* pEdge : path) {
+            cost += pEdge->getWeight();
+        }
+        bool thrown = false;
+        try {
+            csr.addMetric("broken", std::vector<double>(3, 1.0));
+        } catch (Graph::Exception&) {
+            thrown = true;
+        }
+        CsrGraph::tDistances expected = timeCsr.findDistancesDijkstra(0);
+        engine.run(0, CsrGraph::INVALID_INDEX, MetricWeight(csr));
+        if (path.empty() || engine.getDistance(csr.getNumNodes() - 1) > cost || !thrown || csr.findMetric("time") != time
+            || csr.findMetric("weight") != 0 || csr.getNumMetrics() != 2
+            || expected.distance[csr.getNumNodes() - 1] <= engine.getDistance(csr.getNumNodes() - 1)) {
+            std::cout << "Wrong metric!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The QueryExecutor should answer concurrent batches like single Dijkstra queries */
+    void testQueryExecutor()
+    {
+        std::cout << "testQueryExecutor: ";
+
+        Graph grid;
+        makeGeoGridGraph(grid, 20);
+        CsrGraph csr = grid.freeze();
+        std::vector<QueryExecutor::tQuery> queries;
+        for (CsrGraph::tIndex i = 0; i < 500; i++) {
+            QueryExecutor::tQuery query = { (i * 7919) % csr.getNumNodes(), (i * 104729 + 12345) % csr.getNumNodes() };
+            queries.push_back(query);
+        }
+
+        for (QueryExecutor::tAlgorithm algorithm : {QueryExecutor::ALGORITHM_DIJKSTRA, QueryExecutor::ALGORITHM_BIDIRECTIONAL,
+                                                    QueryExecutor::ALGORITHM_ASTAR}) {
+            QueryExecutor executor(csr, 3, algorithm);
+            std::vector<double> distances, otherDistances;
+            std::vector<Graph::tEdges> paths;
+            std::future<void> batch = executor.submit(queries, distances, &paths);
+            std::future<void> otherBatch = executor.submit(queries, otherDistances);
+            batch.get();
+            otherBatch.get();
+
+            for (size_t i = 0; i < queries.size(); i++) {
+                double expected = csr.findDistancesDijkstra(queries[i].src, queries[i].dst).distance[queries[i].dst];
+                double cost = 0.0;
+                for (Edge* pEdge : paths[i]) {
+                    cost += pEdge->getWeight();
+                }
+                if (std::fabs(distances[i] - expected) > 1e-9 || otherDistances[i] != distances[i]
+                    || std::fabs(cost - expected) > 1e-9) {
+                    std::cout << "Wrong distance of query " << i << "!" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        QueryExecutor executor(csr, 2);
+        std::vector<double> distances;
+        QueryExecutor::tQuery invalid = { 0, csr.getNumNodes() };
+        bool thrown = false;
+        try {
+            executor.run(std::vector<QueryExecutor::tQuery>(1, invalid), distances);
+        } catch (Graph::InvalidNodeException&) {
+            thrown = true;
+        }
+        if (!thrown) {
+            std::cout << "Invalid query not detected!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
+    /* TEST: The alternative routes should be loopless and within the stretch bound */
+    void testAlternativeRoutes()
+    {
+        std::cout << "testAlternativeRoutes: ";
+
+        // two chains of ten edges from s to t, the upper one is 10% longer
+        Graph ladder;
+        Node& rSrc = ladder.makeNode<Node>("s");
+        Node& rDst = ladder.makeNode<Node>("t");
+        for (int chain = 0; chain < 2; chain++) {
+            Node* pPrev = &rSrc;
+            for (int i = 1; i < 10; i++) {
+                Node* pNode = &ladder.makeNode<Node>(std::string(chain == 0 ? "a" : "b") + std::to_string(i));
+                ladder.makeBiEdge<SimpleEdge>(*pPrev, *pNode, chain == 0 ? 1.0 : 1.1);
+                pPrev = pNode;
+            }
+            ladder.makeBiEdge<SimpleEdge>(*pPrev, rDst, chain == 0 ? 1.0 : 1.1);
+        }
+        CsrGraph csr = ladder.freeze();
+        CsrGraph::tIndex src = csr.getIndex(rSrc), dst = csr.getIndex(rDst);
+        std::vector<CsrGraph::tRoute> routes = csr.findAlternativeRoutes(rSrc, rDst);
+
+        CsrGraph::tDistances distances = csr.findDistancesDijkstra(src);
+        AlternativeRouteEngine::tOptions options;
+        bool correct = routes.size() == 2 && routes[0].cost == distances.distance[dst];
+        std::set<Graph::tPath> distinct;
+        for (size_t i = 0; correct && i < routes.size(); i++) {
+            std::set<Node*> visited;
+            Node* pNode = csr.getNode(src);
+            visited.insert(pNode);
+            for (Edge* pEdge : routes[i].path) {
+                correct = correct && &pEdge->getSrcNode() == pNode && visited.insert(&pEdge->getDstNode()).second;
+                pNode = &pEdge->getDstNode();
+            }
+            correct = correct && pNode == csr.getNode(dst) && distinct.insert(routes[i].path).second
+                && routes[i].cost <= (1.0 + options.maxStretch) * routes[0].cost;
+        }
+        if (!correct) {
+            std::cout << "Wrong alternative routes!" << std::endl;
+            return;
+        }
+
+        std::cout << "OK" << std::endl;
+    }
+
+
     void measSearchSpeed() {
         
         std::vector<double> execTimes;
@@ -116,6 +673,29 @@ public:
     }
 
 
+    /* Compares findDistancesDijkstraV1 with inlined SimpleEdge weights to the virtual getWeight on a GeoJSON grid. */
+    void measDevirtualizedWeights()
+    {
+        Graph geo;
+        makeGeoGridGraph(geo, 100);
+        CsrGraph csr = geo.freeze();
+
+        std::cout << "measDevirtualizedWeights: ";
+
+        const int numTrees = 5;
+        double virtualTime = 0, inlinedTime = 0;
+        for (int i = 0; i < numTrees; i++) {
+            Node* pSrc = csr.getNode((i * 7919) % csr.getNumNodes());
+            Node* pFound = NULL;
+            virtualTime += getExecutionSpeed([&]() { geo.runDijkstraV1<Edge>(*pSrc, NULL, &pFound); });
+            inlinedTime += getExecutionSpeed([&]() { geo.findDistancesDijkstraV1(*pSrc, NULL, &pFound); });
+        }
+
+        std::cout << "virtual getWeight " << virtualTime / numTrees * 1e3 << "ms; SimpleEdge::getWeight inlined "
+                  << inlinedTime / numTrees * 1e3 << "ms per tree of " << csr.getNumNodes() << " nodes" << std::endl;
+    }
+
+
 private:
 
     Graph g;
@@ -216,6 +796,606 @@ int testGeoJSONConversion() {
 }
 
 
+/* Measures construction time, destruction time and memory of a graph with about 1M edges. */
+void measGraphConstruction()
+{
+    std::cout << "measGraphConstruction: ";
+
+    double rssBefore = getResidentMemoryMB();
+    Graph* pGraph = new Graph();
+
+    double buildTime = getExecutionSpeed([&]() { makeGridGraph(*pGraph, 500); });
+    double rssAfter = getResidentMemoryMB();
+    size_t numEdges = pGraph->getEdges().size();
+
+    double destroyTime = getExecutionSpeed([&]() { delete pGraph; });
+
+    std::cout << numEdges << " edges, build " << buildTime << "s, destroy " << destroyTime << "s";
+    if (rssBefore >= 0) {
+        std::cout << ", RSS +" << (rssAfter - rssBefore) << "MB";
+    }
+    std::cout << std::endl;
+}
+
+
+/* Compares short point-to-point queries of findDistancesDijkstraV1 and the DijkstraEngine. */
+void measShortQueries()
+{
+    std::cout << "measShortQueries: ";
+
+    const int size = 300;
+    Graph g;
+    makeGridGraph(g, size);
+    CsrGraph csr = g.freeze();
+    DijkstraEngine engine(csr);
+
+    // queries between nodes that are 10 steps apart in the grid
+    std::vector<std::pair<Node*, Node*> > queries;
+    for (int i = 0; i < 20; i++) {
+        int x = (i * 37) % (size - 10), y = (i * 53) % (size - 10);
+        queries.push_back(std::make_pair(g.findNodeById(std::to_string(x) + "_" + std::to_string(y)),
+                                         g.findNodeById(std::to_string(x + 5) + "_" + std::to_string(y + 5))));
+    }
+
+    Node* pFound = NULL;
+    double v1Time = getExecutionSpeed([&]() {
+        for (auto& rQuery : queries) g.findDistancesDijkstraV1(*rQuery.first, rQuery.second, &pFound);
+    });
+
+    double engineTime = getExecutionSpeed([&]() {
+        for (auto& rQuery : queries) engine.run(csr.getIndex(*rQuery.first), csr.getIndex(*rQuery.second));
+    });
+
+    std::cout << "V1 " << v1Time / queries.size() * 1e6 << "us, engine "
+              << engineTime / queries.size() * 1e6 << "us per query ("
+              << engine.getNumSettled() << " nodes settled)" << std::endl;
+}
+
+
+/* Compares the settled nodes and query times of the point-to-point searches on a geo graph. */
+void measPointToPoint()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    RoutingContext context(csr);
+    DijkstraEngine dijkstra(csr, context);
+    AStarEngine aStar(csr, context);
+    BidirectionalDijkstraEngine bidirectional(csr, context);
+
+    std::cout << "measPointToPoint: ";
+
+    size_t dijkstraSettled = 0, aStarSettled = 0, bidirectionalSettled = 0;
+    const int numQueries = 20;
+    double dijkstraTime = 0, aStarTime = 0, bidirectionalTime = 0;
+    for (int i = 0; i < numQueries; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+        dijkstraTime += getExecutionSpeed([&]() { dijkstra.run(src, dst); });
+        dijkstraSettled += dijkstra.getNumSettled();
+        aStarTime += getExecutionSpeed([&]() { aStar.run(src, dst); });
+        aStarSettled += aStar.getNumSettled();
+        bidirectionalTime += getExecutionSpeed([&]() { bidirectional.run(src, dst); });
+        bidirectionalSettled += bidirectional.getNumSettled();
+    }
+
+    std::cout << "Dijkstra " << dijkstraSettled / numQueries << " settled, " << dijkstraTime / numQueries * 1e3
+              << "ms; A* " << aStarSettled / numQueries << " settled, " << aStarTime / numQueries * 1e3
+              << "ms; bidirectional " << bidirectionalSettled / numQueries << " settled, "
+              << bidirectionalTime / numQueries * 1e3 << "ms per query" << std::endl;
+}
+
+
+/* Compares CH queries with findDistancesDijkstraV1 and the DijkstraEngine on a graph imported from GeoJSON. */
+void measContractionHierarchy()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    DijkstraEngine dijkstra(csr);
+
+    std::cout << "measContractionHierarchy: ";
+
+    ContractionHierarchy* pCH = NULL;
+    double preprocessingTime = getExecutionSpeed([&]() { pCH = new ContractionHierarchy(csr); });
+    CHQueryEngine query(*pCH);
+
+    size_t dijkstraSettled = 0, chSettled = 0;
+    const int numQueries = 20;
+    double v1Time = 0, dijkstraTime = 0, chTime = 0;
+    for (int i = 0; i < numQueries; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+        Node* pFound = NULL;
+        v1Time += getExecutionSpeed([&]() { g.findDistancesDijkstraV1(*csr.getNode(src), csr.getNode(dst), &pFound); });
+        dijkstraTime += getExecutionSpeed([&]() { dijkstra.run(src, dst); });
+        dijkstraSettled += dijkstra.getNumSettled();
+        chTime += getExecutionSpeed([&]() { query.run(src, dst); });
+        chSettled += query.getNumSettled();
+    }
+
+    std::cout << "preprocessing " << preprocessingTime << "s, " << pCH->getNumShortcuts() << " shortcuts; V1 "
+              << v1Time / numQueries * 1e3 << "ms; Dijkstra " << dijkstraSettled / numQueries << " settled, "
+              << dijkstraTime / numQueries * 1e3 << "ms; CH " << chSettled / numQueries << " settled, "
+              << chTime / numQueries * 1e3 << "ms per query" << std::endl;
+
+    delete pCH;
+}
+
+
+/* Compares the sequential and the parallel CH preprocessing and the query performance of their hierarchies. */
+void measParallelContraction()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+
+    std::cout << "measParallelContraction: ";
+
+    unsigned threadCounts[] = { 1, 0 };
+    for (unsigned numThreads : threadCounts) {
+        ContractionHierarchy::tOptions options;
+        options.numThreads = numThreads;
+        ContractionHierarchy* pCH = NULL;
+        double preprocessingTime = getExecutionSpeed([&]() { pCH = new ContractionHierarchy(csr, options); });
+
+        CHQueryEngine query(*pCH);
+        size_t settled = 0;
+        const int numQueries = 20;
+        double queryTime = 0;
+        for (int i = 0; i < numQueries; i++) {
+            CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+            CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+            queryTime += getExecutionSpeed([&]() { query.run(src, dst); });
+            settled += query.getNumSettled();
+        }
+
+        std::cout << (numThreads == 1 ? "sequential " : "parallel (all hardware threads) ") << preprocessingTime
+                  << "s, " << pCH->getNumShortcuts() << " shortcuts, " << settled / numQueries << " settled, "
+                  << queryTime / numQueries * 1e3 << "ms per query; ";
+        delete pCH;
+    }
+    std::cout << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+}
+
+
+/* Compares ALT with Dijkstra and A* with the haversine heuristic and measures the landmark table. */
+void measALT()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    RoutingContext context(csr);
+    DijkstraEngine dijkstra(csr, context);
+    AStarEngine aStar(csr, context);
+
+    std::cout << "measALT: ";
+
+    LandmarkTable* pTable = NULL;
+    double buildTime = getExecutionSpeed([&]() { pTable = new LandmarkTable(csr); });
+    const char* filename = "landmarks.bin";
+    double saveTime = getExecutionSpeed([&]() { pTable->saveToFile(filename); });
+    LandmarkTable loaded;
+    double loadTime = getExecutionSpeed([&]() { loaded.loadFromFile(csr, filename); });
+    std::remove(filename);
+
+    size_t dijkstraSettled = 0, aStarSettled = 0, altSettled = 0;
+    const int numQueries = 20;
+    double dijkstraTime = 0, aStarTime = 0, altTime = 0;
+    for (int i = 0; i < numQueries; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+        dijkstraTime += getExecutionSpeed([&]() { dijkstra.run(src, dst); });
+        dijkstraSettled += dijkstra.getNumSettled();
+        aStarTime += getExecutionSpeed([&]() { aStar.run(src, dst); });
+        aStarSettled += aStar.getNumSettled();
+        altTime += getExecutionSpeed([&]() { aStar.run(src, dst, LandmarkHeuristic(loaded, src, dst)); });
+        altSettled += aStar.getNumSettled();
+    }
+
+    std::cout << pTable->getNumLandmarks() << " landmarks in " << buildTime << "s, "
+              << csr.getNumNodes() * 2 * pTable->getNumLandmarks() * sizeof(uint32_t) / 1024 << "KB, save "
+              << saveTime * 1e3 << "ms, load " << loadTime * 1e3 << "ms; Dijkstra " << dijkstraSettled / numQueries
+              << " settled, " << dijkstraTime / numQueries * 1e3 << "ms; A* " << aStarSettled / numQueries
+              << " settled, " << aStarTime / numQueries * 1e3 << "ms; ALT " << altSettled / numQueries << " settled, "
+              << altTime / numQueries * 1e3 << "ms per query" << std::endl;
+
+    delete pTable;
+}
+
+
+/* Measures the CRP customization and compares CRP queries with the DijkstraEngine. */
+void measCustomizableRoutePlanning()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    DijkstraEngine dijkstra(csr);
+
+    std::cout << "measCustomizableRoutePlanning: ";
+
+    MultilevelOverlay* pOverlay = NULL;
+    double preprocessingTime = getExecutionSpeed([&]() { pOverlay = new MultilevelOverlay(csr); });
+    double customizationTime = getExecutionSpeed([&]() { pOverlay->customize(); });
+    CRPQueryEngine query(*pOverlay);
+
+    size_t dijkstraSettled = 0, crpSettled = 0;
+    const int numQueries = 20;
+    double dijkstraTime = 0, crpTime = 0;
+    for (int i = 0; i < numQueries; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+        dijkstraTime += getExecutionSpeed([&]() { dijkstra.run(src, dst); });
+        dijkstraSettled += dijkstra.getNumSettled();
+        crpTime += getExecutionSpeed([&]() { query.run(src, dst); });
+        crpSettled += query.getNumSettled();
+    }
+
+    std::cout << pOverlay->getNumLevels() << " levels, " << pOverlay->getNumCliqueArcs() << " clique arcs, preprocessing "
+              << preprocessingTime << "s, customization " << customizationTime << "s on "
+              << std::thread::hardware_concurrency() << " hardware threads; Dijkstra " << dijkstraSettled / numQueries
+              << " settled, " << dijkstraTime / numQueries * 1e3 << "ms; CRP " << crpSettled / numQueries
+              << " settled, " << crpTime / numQueries * 1e3 << "ms per query" << std::endl;
+
+    delete pOverlay;
+}
+
+
+/*
+* Compares hub label distance queries with findDistancesDijkstraV1 and the DijkstraEngine. Grids
+* need far larger labels than road networks, so this one is smaller than the other benchmarks.
+*/
+void measHubLabels()
+{
+    Graph g;
+    makeGeoGridGraph(g, 100);
+    CsrGraph csr = g.freeze();
+    DijkstraEngine dijkstra(csr);
+
+    std::cout << "measHubLabels: ";
+
+    ContractionHierarchy ch(csr);
+    HubLabels* pLabels = NULL;
+    double labelingTime = getExecutionSpeed([&]() { pLabels = new HubLabels(ch); });
+    const char* filename = "hublabels.bin";
+    double saveTime = getExecutionSpeed([&]() { pLabels->saveToFile(filename); });
+    HubLabels loaded;
+    double loadTime = getExecutionSpeed([&]() { loaded.loadFromFile(ch, filename); });
+    std::remove(filename);
+
+    const int numQueries = 20;
+    double v1Time = 0, dijkstraTime = 0, pathTime = 0;
+    Graph::tEdges path;
+    for (int i = 0; i < numQueries; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+        Node* pFound = NULL;
+        v1Time += getExecutionSpeed([&]() { g.findDistancesDijkstraV1(*csr.getNode(src), csr.getNode(dst), &pFound); });
+        dijkstraTime += getExecutionSpeed([&]() { dijkstra.run(src, dst); });
+        pathTime += getExecutionSpeed([&]() { loaded.findShortestPath(src, dst, path); });
+    }
+
+    // a single distance query is too fast for the clock, so many of them are timed at once
+    const int numDistanceQueries = 1000000;
+    double checksum = 0;
+    double distanceTime = getExecutionSpeed([&]() {
+        for (int i = 0; i < numDistanceQueries; i++) {
+            checksum += loaded.getDistance((i * 7919u) % csr.getNumNodes(), (i * 104729u + 12345) % csr.getNumNodes());
+        }
+    });
+
+    std::cout << "labeling " << labelingTime << "s, " << static_cast<double>(loaded.getNumEntries()) / csr.getNumNodes() / 2
+              << " hubs per label, " << loaded.getNumEntries() * (sizeof(CsrGraph::tIndex) * 2 + sizeof(double)) / (1024 * 1024)
+              << "MB, save " << saveTime * 1e3 << "ms, load " << loadTime * 1e3 << "ms; V1 " << v1Time / numQueries * 1e3
+              << "ms; Dijkstra " << dijkstraTime / numQueries * 1e3 << "ms; labels " << distanceTime / numDistanceQueries * 1e6
+              << "us per distance, " << pathTime / numQueries * 1e6 << "us per path (checksum " << checksum << ")" << std::endl;
+
+    delete pLabels;
+}
+
+
+/* Compares the distance matrices of CsrGraph and the ContractionHierarchy with one Graph query per entry. */
+void measDistanceMatrix()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+
+    std::cout << "measDistanceMatrix: ";
+
+    const size_t size = 200;
+    std::vector<CsrGraph::tIndex> sources, targets;
+    for (size_t i = 0; i < size; i++) {
+        sources.push_back((i * 7919) % csr.getNumNodes());
+        targets.push_back((i * 104729 + 12345) % csr.getNumNodes());
+    }
+
+    // the old way: one query per entry, timed for a few entries only
+    const int numPairs = 10;
+    double pairTime = 0;
+    for (int i = 0; i < numPairs; i++) {
+        pairTime += getExecutionSpeed([&]() { g.findShortestPathDijkstra(*csr.getNode(sources[i]), *csr.getNode(targets[i]), true); });
+    }
+
+    std::vector<double> matrix;
+    double dijkstraTime = getExecutionSpeed([&]() { matrix = csr.computeDistanceMatrix(sources, targets); });
+    ContractionHierarchy ch(csr);
+    double chTime = getExecutionSpeed([&]() { matrix = ch.computeDistanceMatrix(sources, targets); });
+
+    std::cout << size << "x" << size << ": findShortestPathDijkstra " << pairTime / numPairs * size * size
+              << "s (extrapolated); Dijkstra matrix " << dijkstraTime << "s; CH matrix " << chTime << "s on "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+}
+
+
+/* Compares full shortest path trees of PHAST with findDistancesDijkstraV1 and CsrGraph::findDistancesDijkstra. */
+void measPHAST()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    ContractionHierarchy ch(csr);
+    PhastEngine phast(ch);
+
+    std::cout << "measPHAST: ";
+
+    const int numTrees = 16;
+    std::vector<CsrGraph::tIndex> sources;
+    for (int i = 0; i < numTrees; i++) {
+        sources.push_back((i * 7919) % csr.getNumNodes());
+    }
+
+    Node* pFound = NULL;
+    double v1Time = getExecutionSpeed([&]() { g.findDistancesDijkstraV1(*csr.getNode(sources[0]), NULL, &pFound); });
+    double dijkstraTime = 0, phastTime = 0;
+    for (CsrGraph::tIndex src : sources) {
+        dijkstraTime += getExecutionSpeed([&]() { csr.findDistancesDijkstra(src); });
+        phastTime += getExecutionSpeed([&]() { phast.run(src); });
+    }
+    double batchTime = getExecutionSpeed([&]() { phast.run(sources); });
+
+    std::cout << "V1 " << v1Time * 1e3 << "ms; Dijkstra " << dijkstraTime / numTrees * 1e3 << "ms; PHAST "
+              << phastTime / numTrees * 1e3 << "ms, " << numTrees << " sources per sweep " << batchTime / numTrees * 1e3
+              << "ms per tree" << std::endl;
+}
+
+
+/* Compares an isochrone with findReachable to a full findDistancesDijkstra that is filtered afterwards. */
+void measIsochrone()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    RoutingContext context(csr);
+
+    std::cout << "measIsochrone: ";
+
+    CsrGraph::tIndex src = csr.getNumNodes() / 2 + 100;
+    const double budget = 2.0;
+    std::vector<CsrGraph::tIndex> filtered;
+    double fullTime = getExecutionSpeed([&]() {
+        CsrGraph::tDistances distances = csr.findDistancesDijkstra(src);
+        filtered.clear();
+        for (CsrGraph::tIndex v = 0; v < csr.getNumNodes(); v++) {
+            if (distances.distance[v] <= budget) {
+                filtered.push_back(v);
+            }
+        }
+    });
+
+    CsrGraph::tReachable reachable;
+    double reachableTime = getExecutionSpeed([&]() { csr.findReachable(*csr.getNode(src), budget, context, reachable); });
+    std::string isochrone;
+    double hullTime = getExecutionSpeed([&]() { isochrone = GeoJSONGraphConverter::toIsochrone(csr, reachable); });
+
+    std::cout << reachable.nodes.size() << " of " << csr.getNumNodes() << " nodes within " << budget << "km: full Dijkstra "
+              << fullTime * 1e3 << "ms; findReachable " << reachableTime * 1e3 << "ms; GeoJSON hull " << hullTime * 1e3
+              << "ms" << std::endl;
+}
+
+
+/* Measures the k shortest paths on a grid, which has many paths of similar cost. */
+void measKShortestPaths()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    YenEngine engine(csr);
+
+    std::cout << "measKShortestPaths: ";
+
+    const size_t k = 10;
+    CsrGraph::tIndex src = 1234, dst = csr.getNumNodes() - 4321;
+    double yenTime = getExecutionSpeed([&]() { engine.run(src, dst, k); });
+    double dijkstraTime = getExecutionSpeed([&]() { csr.findShortestPathDijkstra(*csr.getNode(src), *csr.getNode(dst)); });
+
+    std::cout << k << " paths " << yenTime * 1e3 << "ms (" << engine.getNumSpurSearches()
+              << " spur searches beyond the shortest path tree); one Dijkstra path " << dijkstraTime * 1e3 << "ms" << std::endl;
+}
+
+
+/* Measures the via-node alternatives on a grid, compared to a single Dijkstra query. */
+void measAlternativeRoutes()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    AlternativeRouteEngine engine(csr);
+    DijkstraEngine dijkstra(csr);
+
+    std::cout << "measAlternativeRoutes: ";
+
+    const int numQueries = 20;
+    double alternativeTime = 0, dijkstraTime = 0;
+    size_t numAlternatives = 0;
+    for (int i = 0; i < numQueries; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+        alternativeTime += getExecutionSpeed([&]() { numAlternatives += engine.run(src, dst) - 1; });
+        dijkstraTime += getExecutionSpeed([&]() { dijkstra.run(src, dst); });
+    }
+
+    std::cout << "via-node " << alternativeTime / numQueries * 1e3 << "ms with " << double(numAlternatives) / numQueries
+              << " alternatives on average; Dijkstra " << dijkstraTime / numQueries * 1e3 << "ms" << std::endl;
+}
+
+
+/* Compares delta-stepping on different numbers of threads with a full Dijkstra tree. */
+void measDeltaStepping()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+
+    std::cout << "measDeltaStepping: ";
+
+    CsrGraph::tIndex src = csr.getNumNodes() / 2 + 100;
+    double dijkstraTime = getExecutionSpeed([&]() { csr.findDistancesDijkstra(src); });
+    std::cout << "Dijkstra " << dijkstraTime * 1e3 << "ms";
+
+    unsigned maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    for (unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        DeltaSteppingEngine engine(csr, 0.0, numThreads);
+        double time = getExecutionSpeed([&]() { engine.run(src); });
+        std::cout << "; " << numThreads << " threads " << time * 1e3 << "ms";
+    }
+    std::cout << " (" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+}
+
+
+/* Compares the throughput of full Dijkstra trees with the priority queue policies on a unit grid and a geo grid. */
+void measPriorityQueues()
+{
+    Graph unitGrid, geoGrid;
+    makeGridGraph(unitGrid, 300);
+    makeGeoGridGraph(geoGrid, 200);
+    CsrGraph unitCsr = unitGrid.freeze();
+    CsrGraph geoCsr = geoGrid.freeze();
+
+    std::cout << "measPriorityQueues:";
+
+    for (const CsrGraph* pCsr : {&unitCsr, &geoCsr}) {
+        // the geo weights are km, as integer keys in meters
+        double scale = pCsr == &unitCsr ? 1.0 : 1000.0;
+        DijkstraEngine engine(*pCsr);
+        BinaryHeapQueue binary;
+        QuaternaryHeapQueue quaternary;
+        RadixHeapQueue radix(scale);
+        DialQueue dial(*pCsr, scale);
+        const char* names[] = {"binary", "4-ary", "radix", "Dial"};
+
+        std::cout << (pCsr == &unitCsr ? " unit grid" : "; geo grid") << " (" << pCsr->getNumNodes() << " nodes)";
+        const int numTrees = 5;
+        for (int queue = 0; queue < 4; queue++) {
+            double time = 0;
+            for (int i = 0; i < numTrees; i++) {
+                CsrGraph::tIndex src = (i * 7919) % pCsr->getNumNodes();
+                time += getExecutionSpeed([&]() {
+                    if (queue == 0) engine.run(src, binary);
+                    if (queue == 1) engine.run(src, quaternary);
+                    if (queue == 2) engine.run(src, radix);
+                    if (queue == 3) engine.run(src, dial);
+                });
+            }
+            std::cout << " " << names[queue] << " " << numTrees * pCsr->getNumNodes() / time * 1e-6 << "M";
+        }
+    }
+    std::cout << " nodes per second" << std::endl;
+}
+
+
+/* Compares full Dijkstra trees on the double weights with the ones on the fixed point weights in meters. */
+void measFixedPointWeights()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze(1e-3);
+    DijkstraEngine dijkstra(csr);
+    FixedPointDijkstraEngine fixedPoint(csr);
+    BinaryHeapQueue binary;
+    RadixHeapQueue radix(1000.0);
+
+    std::cout << "measFixedPointWeights: ";
+
+    const int numTrees = 5;
+    double doubleTime = 0, doubleRadixTime = 0, fixedTime = 0, fixedBinaryTime = 0;
+    for (int i = 0; i < numTrees; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        doubleTime += getExecutionSpeed([&]() { dijkstra.run(src, binary); });
+        doubleRadixTime += getExecutionSpeed([&]() { dijkstra.run(src, radix); });
+        fixedTime += getExecutionSpeed([&]() { fixedPoint.run(src); });
+        fixedBinaryTime += getExecutionSpeed([&]() { fixedPoint.run(src, CsrGraph::INVALID_INDEX, binary); });
+    }
+
+    std::cout << "double weights " << doubleTime / numTrees * 1e3 << "ms, with radix heap " << doubleRadixTime / numTrees * 1e3
+              << "ms; fixed point " << fixedTime / numTrees * 1e3 << "ms, with binary heap "
+              << fixedBinaryTime / numTrees * 1e3 << "ms per tree" << std::endl;
+}
+
+
+/* Routes one snapshot with three metrics and compares the memory of a weight column with the one of the graph. */
+void measMetrics()
+{
+    double memoryBefore = getResidentMemoryMB();
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+    double graphMemory = getResidentMemoryMB() - memoryBefore;
+
+    // free flow at 50 km/h, trucks at 30 km/h on every third road, in minutes
+    CsrGraph::tMetric freeFlow = csr.addMetric("free flow", [&csr](CsrGraph::tIndex e) { return csr.getWeight(e) * 60 / 50; });
+    CsrGraph::tMetric truck = csr.addMetric("truck", [&csr](CsrGraph::tIndex e) {
+        return csr.getWeight(e) * 60 / (csr.getHead(e) % 3 == 0 ? 30 : 50);
+    });
+    DijkstraEngine engine(csr);
+
+    std::cout << "measMetrics: ";
+
+    const int numQueries = 20;
+    double times[3] = {0, 0, 0};
+    for (int i = 0; i < numQueries; i++) {
+        CsrGraph::tIndex src = (i * 7919) % csr.getNumNodes();
+        CsrGraph::tIndex dst = (i * 104729 + 12345) % csr.getNumNodes();
+        times[0] += getExecutionSpeed([&]() { engine.run(src, dst); });
+        times[1] += getExecutionSpeed([&]() { engine.run(src, dst, MetricWeight(csr, freeFlow)); });
+        times[2] += getExecutionSpeed([&]() { engine.run(src, dst, MetricWeight(csr, truck)); });
+    }
+
+    for (CsrGraph::tMetric metric = 0; metric < 3; metric++) {
+        std::cout << csr.getMetricName(metric) << " " << times[metric] / numQueries * 1e3 << "ms; ";
+    }
+    std::cout << "a column " << csr.getNumEdges() * sizeof(double) / (1024.0 * 1024.0) << "MB, the graph and snapshot "
+              << graphMemory << "MB" << std::endl;
+}
+
+
+/* Measures the throughput of the QueryExecutor on different numbers of threads. */
+void measQueryExecutor()
+{
+    Graph g;
+    makeGeoGridGraph(g, 200);
+    CsrGraph csr = g.freeze();
+
+    std::cout << "measQueryExecutor: ";
+
+    std::vector<QueryExecutor::tQuery> queries;
+    for (CsrGraph::tIndex i = 0; i < 2000; i++) {
+        QueryExecutor::tQuery query = { (i * 7919) % csr.getNumNodes(), (i * 104729 + 12345) % csr.getNumNodes() };
+        queries.push_back(query);
+    }
+
+    std::vector<double> distances;
+    unsigned maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    for (unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        QueryExecutor executor(csr, numThreads);
+        double time = getExecutionSpeed([&]() { executor.run(queries, distances); });
+        std::cout << numThreads << " threads " << queries.size() / time << " queries/s (" << executor.getNumSteals()
+                  << " steals); ";
+    }
+    std::cout << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+}
+
+
 int main2()
 {
     GraphTesting gt;
@@ -223,9 +1403,39 @@ int main2()
     std::cout << "---- Test results: --------------" << std::endl;
     gt.testNodeOrder();
     gt.testRouting();
+    gt.testNeighbours();
+    gt.testCsrRouting();
+    gt.testDistanceMatrix();
+    gt.testReachable();
+    gt.testKShortestPaths();
+    gt.testAlternativeRoutes();
+    gt.testPriorityQueues();
+    gt.testFixedPointWeights();
+    gt.testDevirtualizedWeights();
+    gt.testMetrics();
+    gt.testQueryExecutor();
 
     std::cout << "---- Time measurements: ---------" << std::endl;
     gt.measSearchSpeed();
+    measGraphConstruction();
+    measShortQueries();
+    measPointToPoint();
+    measContractionHierarchy();
+    measParallelContraction();
+    measALT();
+    measCustomizableRoutePlanning();
+    measHubLabels();
+    measDistanceMatrix();
+    measPHAST();
+    measIsochrone();
+    measKShortestPaths();
+    measAlternativeRoutes();
+    measDeltaStepping();
+    measPriorityQueues();
+    measFixedPointWeights();
+    gt.measDevirtualizedWeights();
+    measMetrics();
+    measQueryExecutor();
 
     return 0;
 }